@@ -0,0 +1,51 @@
+/*
+  ==============================================================================
+
+    AlignedArena.h
+    Created: 17/10/2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/*
+Single zero-initialised float block whose start is aligned to a cache line.
+Used to pack many per-mode arrays in one allocation: callers carve it into
+arrays whose lengths are multiples of kAlignmentFloats, so that each of them
+starts on a cache line too.
+*/
+class AlignedArena
+{
+public:
+    static constexpr std::size_t kAlignmentBytes = 64;
+    static constexpr std::size_t kAlignmentFloats = kAlignmentBytes / sizeof(float);
+
+    //Rounds aNumFloats up to a whole number of cache lines
+    static std::size_t RoundUp(std::size_t aNumFloats)
+    {
+        return (aNumFloats + kAlignmentFloats - 1) / kAlignmentFloats * kAlignmentFloats;
+    }
+
+    //Reallocates the arena with aNumFloats zeros, invalidating previous pointers
+    void Allocate(std::size_t aNumFloats)
+    {
+        mStorage.assign(aNumFloats + kAlignmentFloats, 0.f);
+        auto vAddress = reinterpret_cast<std::uintptr_t>(mStorage.data());
+        auto vOffset = (kAlignmentBytes - vAddress % kAlignmentBytes) % kAlignmentBytes;
+        mpData = mStorage.data() + vOffset / sizeof(float);
+        mSize = aNumFloats;
+    }
+
+    float* GetData() { return mpData; }
+    std::size_t GetSize() const { return mSize; }
+
+private:
+    std::vector<float> mStorage;
+    float* mpData{ nullptr };
+    std::size_t mSize{ 0 };
+};
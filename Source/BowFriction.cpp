@@ -0,0 +1,77 @@
+#include "BowFriction.h"
+
+namespace BowFriction
+{
+    const char* GetAccuracyName(Accuracy aAccuracy)
+    {
+        switch (aAccuracy)
+        {
+        case Accuracy::Exact:
+            return "Exact";
+        case Accuracy::Polynomial:
+            return "Polynomial";
+        case Accuracy::Table:
+            return "Table";
+        }
+        return "Unknown";
+    }
+
+    Table::Table(float aA, int aPointsNumber)
+    {
+        mA = aA;
+        mEtaMax = sqrt(-kMinExponent / aA);
+        mInvStep = (aPointsNumber - 1) / (2 * mEtaMax);
+        mLastPos = static_cast<float>(aPointsNumber - 1);
+
+        //Tabulated in double precision, so that only the interpolation adds error
+        mValues.resize(2 * static_cast<std::size_t>(aPointsNumber));
+        for (int i = 0; i < aPointsNumber; ++i)
+        {
+            double vEta = -mEtaMax + 2.0 * mEtaMax * i / (aPointsNumber - 1);
+            double vD, vLambda;
+            EvaluateExact(static_cast<double>(aA), vEta, vD, vLambda);
+            mValues[2 * i] = static_cast<float>(vD);
+            mValues[2 * i + 1] = static_cast<float>(vLambda);
+        }
+    }
+
+    Evaluator::Evaluator(float aA, Accuracy aAccuracy)
+    {
+        mA = aA;
+        mSqrt2A = sqrt(2 * aA);
+        mAccuracy = Accuracy::Exact;
+        SetAccuracy(aAccuracy);
+    }
+
+    void Evaluator::SetAccuracy(Accuracy aAccuracy)
+    {
+        if (aAccuracy == Accuracy::Table && !mpTable)
+        {
+            mpTable = std::make_shared<const Table>(mA);
+        }
+        mAccuracy = aAccuracy;
+    }
+
+    void Evaluator::Evaluate(const ModalKernels::Kernel& aKernel, const float* apEta, float* apD, float* apLambda, int aCount) const
+    {
+        switch (mAccuracy)
+        {
+        case Accuracy::Exact:
+            for (int i = 0; i < aCount; ++i)
+            {
+                EvaluateExact(mSqrt2A, mA, apEta[i], apD[i], apLambda[i]);
+            }
+            break;
+        case Accuracy::Polynomial:
+            aKernel.mpFriction({ mA, mSqrt2A, apEta, apD, apLambda, aCount });
+            break;
+        case Accuracy::Table:
+            //The table lookups are gathers, they run lane by lane
+            for (int i = 0; i < aCount; ++i)
+            {
+                mpTable->Evaluate(apEta[i], apD[i], apLambda[i]);
+            }
+            break;
+        }
+    }
+}
@@ -0,0 +1,146 @@
+/*
+  ==============================================================================
+
+    BowFriction.h
+    Created: 17/10/2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cmath>
+#include <memory>
+#include <vector>
+#include "ModalKernels.h"
+
+/*
+Friction characteristic of the bow, evaluated by the non-iterative schemes at
+each step from the relative velocity eta of bow and string:
+
+    d(eta)      = sqrt(2a) * exp(-a * eta^2 + 1/2)
+    lambda(eta) = d(eta) * (1 - 2a * eta^2)
+
+The exponential is the only transcendental of the per-sample update, so three
+accuracy tiers are available:
+
+    Exact       the expression above with the standard exp
+    Polynomial  exp through 2^n times a degree 6 minimax polynomial, the
+                ModalKernels friction kernel, so that many contacts are
+                evaluated on every SIMD lane at once
+    Table       linear interpolation of d and lambda tabulated over the eta
+                range where d is above 1e-9 of its peak, zero outside
+
+Against the double precision terms, for a = 100 and |eta| <= 1, the largest
+errors measured are, relative to d where d is above 1e-9 of its peak and
+relative to the peak of d for lambda:
+
+                d           lambda
+    Exact       1.8e-6      1.2e-7      rounding of the exponent in float
+    Polynomial  2.5e-6      1.6e-7
+    Table       1.3e-6      3.8e-6      of the peak of d, 4096 points
+*/
+namespace BowFriction
+{
+    enum class Accuracy
+    {
+        Exact = 0,
+        Polynomial,
+        Table
+    };
+
+    const char* GetAccuracyName(Accuracy aAccuracy);
+
+    //Reference terms, aSqrt2A is sqrt(2 * aA)
+    inline void EvaluateExact(float aSqrt2A, float aA, float aEta, float& aD, float& aLambda)
+    {
+        aD = aSqrt2A * exp(-aA * aEta * aEta + 0.5f);
+        aLambda = aD * (1 - 2 * aA * aEta * aEta);
+    }
+
+    //Reference terms of the time domain schemes, in double precision
+    inline void EvaluateExact(double aA, double aEta, double& aD, double& aLambda)
+    {
+        aD = sqrt(2.0 * aA) * exp(-aA * aEta * aEta + 0.5);
+        aLambda = aD * (1.0 - 2.0 * aA * aEta * aEta);
+    }
+
+    //d and lambda tabulated for one value of a
+    class Table
+    {
+    public:
+        static constexpr int kDefaultPointsNumber = 4096;
+
+        //Exponent -a * eta^2 at the ends of the table, where d is 1e-9 of its peak
+        static constexpr float kMinExponent = -20.7232658f;
+
+        Table(float aA, int aPointsNumber = kDefaultPointsNumber);
+
+        void Evaluate(float aEta, float& aD, float& aLambda) const
+        {
+            float vPos = (aEta + mEtaMax) * mInvStep;
+            if (!(vPos >= 0.f && vPos < mLastPos))
+            {
+                aD = 0.f;
+                aLambda = 0.f;
+                return;
+            }
+            int vIndex = static_cast<int>(vPos);
+            float vFrac = vPos - vIndex;
+            const float* vpPoint = mValues.data() + 2 * vIndex;
+            aD = vpPoint[0] + vFrac * (vpPoint[2] - vpPoint[0]);
+            aLambda = vpPoint[1] + vFrac * (vpPoint[3] - vpPoint[1]);
+        }
+
+        float GetA() const { return mA; }
+
+    private:
+        float mA;
+        float mEtaMax;
+        float mInvStep;
+        float mLastPos;
+
+        //Interleaved d and lambda of each point
+        std::vector<float> mValues;
+    };
+
+    /*
+    Evaluates the friction of one or many contacts with the selected accuracy.
+    Selecting the table tier builds the table, so SetAccuracy is not to be
+    called while the audio thread is evaluating.
+    */
+    class Evaluator
+    {
+    public:
+        explicit Evaluator(float aA, Accuracy aAccuracy = Accuracy::Exact);
+
+        void SetAccuracy(Accuracy aAccuracy);
+        Accuracy GetAccuracy() const { return mAccuracy; }
+
+        //Terms of a single contact, aKernel is used by the polynomial tier
+        void Evaluate(const ModalKernels::Kernel& aKernel, float aEta, float& aD, float& aLambda) const
+        {
+            switch (mAccuracy)
+            {
+            case Accuracy::Exact:
+                EvaluateExact(mSqrt2A, mA, aEta, aD, aLambda);
+                break;
+            case Accuracy::Polynomial:
+                aKernel.mpFriction({ mA, mSqrt2A, &aEta, &aD, &aLambda, 1 });
+                break;
+            case Accuracy::Table:
+                mpTable->Evaluate(aEta, aD, aLambda);
+                break;
+            }
+        }
+
+        //Terms of aCount independent contacts, e.g. one per voice
+        void Evaluate(const ModalKernels::Kernel& aKernel, const float* apEta, float* apD, float* apLambda, int aCount) const;
+
+    private:
+        float mA;
+        float mSqrt2A;
+        Accuracy mAccuracy;
+        std::shared_ptr<const Table> mpTable;
+    };
+}
@@ -8,8 +8,8 @@
   ==============================================================================
 */
 
-#include <JuceHeader.h>
 #include "Bowed1DWaveFirstOrder.h"
+#include "BowFriction.h"
 
 //==============================================================================
 Bowed1DWaveFirstOrder::Bowed1DWaveFirstOrder (double k) : k (k)
@@ -141,65 +141,6 @@ Bowed1DWaveFirstOrder::~Bowed1DWaveFirstOrder()
 {
 }
 
-void Bowed1DWaveFirstOrder::paint (juce::Graphics& g)
-{
-    // clear the background
-    g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
-    
-#ifdef RUN_ALL
-    // draw the state of the reference solution
-    g.setColour (Colours::green);
-    g.strokePath (visualiseState (g, 50000, &xRef.coeffRef (0), 0.2 * getHeight()), PathStrokeType(2.0f));
-
-    // draw the state of the optimised matrix form
-    g.setColour (Colours::yellow);
-    g.strokePath (visualiseState (g, 50000, &x.coeffRef (0), -0.2 * getHeight()), PathStrokeType(2.0f));
-    
-    // draw the state of the vector form
-    g.setColour (Colours::cyan);
-    g.strokePath (visualiseState (g, 50000, xVec[1], 0), PathStrokeType(2.0f));
-#else
-    // only draw the state of the vector form
-    g.setColour (Colours::cyan);
-    g.strokePath (visualiseState (g, 50000, xVec[1], 0), PathStrokeType(2.0f));
-
-#endif
-    
-}
-
-
-Path Bowed1DWaveFirstOrder::visualiseState (Graphics& g, double visualScaling, double* x, double offset)
-{
-    // String-boundaries are in the vertical middle of the component with a given offset
-    double stringBoundaries = getHeight() / 2.0 + offset;
-    
-    // initialise path
-    Path stringPath;
-    
-    // start path
-    stringPath.startNewSubPath (0, 0 * visualScaling + stringBoundaries);
-    
-    double spacing = getWidth() / static_cast<double>(N);
-    double xLoc = spacing;
-    
-    for (int l = 0; l < N; l++)
-    {
-        // Needs to be -x, because a positive x would visually go down
-        float newY = -x[l+N] * visualScaling + stringBoundaries;
-        
-        // if we get NAN values, make sure that we don't get an exception
-        if (isnan(newY))
-            newY = 0;
-        
-        stringPath.lineTo (xLoc, newY);
-        xLoc += spacing;
-    }
-    
-    stringPath.lineTo (xLoc, stringBoundaries);
-    return stringPath;
-}
-
-
 void Bowed1DWaveFirstOrder::recalculateZeta()
 {
     // Identify where the non-zero values of zeta are
@@ -261,8 +202,7 @@ void Bowed1DWaveFirstOrder::calculateFirstOrderRef()
     double bowLoc = xB * N / L; // xB can be made user-controlled
     eta = h * 1.0 / h * xRef.data()[N + (int)floor(bowLoc)] - vB;
 
-    lambda = sqrt(2.0*a) * (1.0 - 2.0 * a * eta * eta) * exp(-a * eta * eta + 0.5);
-    d = sqrt(2.0 * a) * exp(-a * eta * eta + 0.5);
+    BowFriction::EvaluateExact(a, eta, d, lambda);
 
     Bmat = Bpre + (Fb * h * (0.5 * lambda - d) * zetaZetaT);
     
@@ -297,8 +237,7 @@ void Bowed1DWaveFirstOrder::calculateFirstOrderOpt()
     eta = h * 1.0 / h * x.data()[N + (int)floor(bowLoc)] - vB;
     
     // Non-iterative coefficients
-    lambda = sqrt(2.0*a) * (1.0 - 2.0 * a * eta * eta) * exp(-a * eta * eta + 0.5);
-    d = sqrt(2.0 * a) * exp(-a * eta * eta + 0.5);
+    BowFriction::EvaluateExact(a, eta, d, lambda);
 
     // Sherman-Morrison
     double invDiv = 1.0 + Fb * h * lambda * 0.5 * zTz;
@@ -326,8 +265,7 @@ void Bowed1DWaveFirstOrder::calculateFirstOrderOptVec()
     eta = h * 1.0 / h * xVec[1][N + (int)floor(bowLoc)] - vB; // should include zeta here as well if interpolation is used
     
     // Non-iterative coefficients
-    lambda = sqrt(2.0*a) * (1.0 - 2.0 * a * eta * eta) * exp(-a * eta * eta + 0.5);
-    d = sqrt(2.0 * a) * exp(-a * eta * eta + 0.5);
+    BowFriction::EvaluateExact(a, eta, d, lambda);
     
     // Calculate A^{-1} (Sherman-Morrison)
     double invDiv = 1.0 + Fb * h * lambda * 0.5 * zTz;
@@ -10,22 +10,23 @@
 
 #pragma once
 
-#include <JuceHeader.h>
+#include <cmath>
+#include <vector>
 #include "Global.h"
 
 //==============================================================================
 /*
+    First-order bowed string in the time domain. The state is drawn by
+    Bowed1DWaveFirstOrderView.
 */
-class Bowed1DWaveFirstOrder : public juce::Component
+class Bowed1DWaveFirstOrder
 {
 public:
     Bowed1DWaveFirstOrder (double k);
-    ~Bowed1DWaveFirstOrder() override;
+    ~Bowed1DWaveFirstOrder();
 
-    void paint (juce::Graphics&) override;
-    
-    // Function to draw the state of the system
-    Path visualiseState (Graphics& g, double visualScaling, double* x, double offset);
+    Bowed1DWaveFirstOrder (const Bowed1DWaveFirstOrder&) = delete;
+    Bowed1DWaveFirstOrder& operator= (const Bowed1DWaveFirstOrder&) = delete;
     
     void calculateFirstOrderRef(); // Reference first order system calculation
     void calculateFirstOrderOptVec(); // Optimised first order system calculation with vectors
@@ -36,6 +37,14 @@ public:
     // Function to check whether the optimised version is equal to the reference (within machine precision (here considered to be < 1e-10))
     double getDiffSum();
     
+    // Number of grid points, the displacements are stored after the first N states
+    int getNumGridPoints() { return N; };
+    
+    // States of the reference, optimised matrix and optimised vector forms (for visualisation)
+    double* getRefState() { return &xRef.coeffRef (0); };
+    double* getOptState() { return &x.coeffRef (0); };
+    double* getOptVecState() { return xVec[1]; };
+    
 private:
     // Recalculate the zeta vector
     void recalculateZeta();
@@ -85,5 +94,4 @@ private:
     
     // Sum of the difference between the refence and the optimised states (used for debugging purposes only)
     double diffsum;
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Bowed1DWaveFirstOrder)
 };
@@ -0,0 +1,78 @@
+/*
+  ==============================================================================
+
+    Bowed1DWaveFirstOrderView.cpp
+    Created: 17/10/2026
+
+  ==============================================================================
+*/
+
+#include "Bowed1DWaveFirstOrderView.h"
+
+//==============================================================================
+Bowed1DWaveFirstOrderView::Bowed1DWaveFirstOrderView (std::shared_ptr<Bowed1DWaveFirstOrder> bowed1DWaveFirstOrder) : bowed1DWaveFirstOrder (bowed1DWaveFirstOrder)
+{
+}
+
+Bowed1DWaveFirstOrderView::~Bowed1DWaveFirstOrderView()
+{
+}
+
+void Bowed1DWaveFirstOrderView::paint (juce::Graphics& g)
+{
+    // clear the background
+    g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
+    
+#ifdef RUN_ALL
+    // draw the state of the reference solution
+    g.setColour (Colours::green);
+    g.strokePath (visualiseState (g, 50000, bowed1DWaveFirstOrder->getRefState(), 0.2 * getHeight()), PathStrokeType(2.0f));
+
+    // draw the state of the optimised matrix form
+    g.setColour (Colours::yellow);
+    g.strokePath (visualiseState (g, 50000, bowed1DWaveFirstOrder->getOptState(), -0.2 * getHeight()), PathStrokeType(2.0f));
+    
+    // draw the state of the vector form
+    g.setColour (Colours::cyan);
+    g.strokePath (visualiseState (g, 50000, bowed1DWaveFirstOrder->getOptVecState(), 0), PathStrokeType(2.0f));
+#else
+    // only draw the state of the vector form
+    g.setColour (Colours::cyan);
+    g.strokePath (visualiseState (g, 50000, bowed1DWaveFirstOrder->getOptVecState(), 0), PathStrokeType(2.0f));
+
+#endif
+    
+}
+
+
+Path Bowed1DWaveFirstOrderView::visualiseState (Graphics& g, double visualScaling, double* x, double offset)
+{
+    // String-boundaries are in the vertical middle of the component with a given offset
+    double stringBoundaries = getHeight() / 2.0 + offset;
+    
+    // initialise path
+    Path stringPath;
+    
+    // start path
+    stringPath.startNewSubPath (0, 0 * visualScaling + stringBoundaries);
+    
+    int N = bowed1DWaveFirstOrder->getNumGridPoints();
+    double spacing = getWidth() / static_cast<double>(N);
+    double xLoc = spacing;
+    
+    for (int l = 0; l < N; l++)
+    {
+        // Needs to be -x, because a positive x would visually go down
+        float newY = -x[l+N] * visualScaling + stringBoundaries;
+        
+        // if we get NAN values, make sure that we don't get an exception
+        if (isnan(newY))
+            newY = 0;
+        
+        stringPath.lineTo (xLoc, newY);
+        xLoc += spacing;
+    }
+    
+    stringPath.lineTo (xLoc, stringBoundaries);
+    return stringPath;
+}
@@ -0,0 +1,34 @@
+/*
+  ==============================================================================
+
+    Bowed1DWaveFirstOrderView.h
+    Created: 17/10/2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "Bowed1DWaveFirstOrder.h"
+
+//==============================================================================
+/*
+    Draws the state of a Bowed1DWaveFirstOrder, which does not depend on JUCE.
+*/
+class Bowed1DWaveFirstOrderView : public juce::Component
+{
+public:
+    Bowed1DWaveFirstOrderView (std::shared_ptr<Bowed1DWaveFirstOrder> bowed1DWaveFirstOrder);
+    ~Bowed1DWaveFirstOrderView() override;
+
+    void paint (juce::Graphics&) override;
+    
+    // Function to draw the state of the system
+    Path visualiseState (Graphics& g, double visualScaling, double* x, double offset);
+    
+private:
+    std::shared_ptr<Bowed1DWaveFirstOrder> bowed1DWaveFirstOrder;
+    
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR (Bowed1DWaveFirstOrderView)
+};
@@ -0,0 +1,112 @@
+/*
+  ==============================================================================
+
+    CommandQueue.h
+    Created: 17/10/2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/*
+Bounded lock-free queue with one producer and one consumer thread, e.g. the
+message thread posting commands and the audio thread applying them at the
+start of each block, or a stream of samples. The slots are allocated at
+construction, Push and Pop never allocate nor block: Push fails when the queue
+is full and Pop when it is empty.
+*/
+template <class T>
+class CommandQueue
+{
+public:
+    //The capacity is rounded up to a power of two
+    explicit CommandQueue(std::size_t aCapacity)
+    {
+        std::size_t vCapacity = 1;
+        while (vCapacity < aCapacity)
+        {
+            vCapacity *= 2;
+        }
+        mSlots.resize(vCapacity);
+        mMask = vCapacity - 1;
+    }
+
+    CommandQueue(const CommandQueue&) = delete;
+    CommandQueue& operator=(const CommandQueue&) = delete;
+
+    //Producer side, returns false if the queue is full
+    bool Push(const T& aCommand)
+    {
+        const std::size_t vWrite = mWrite.load(std::memory_order_relaxed);
+        if (vWrite - mRead.load(std::memory_order_acquire) > mMask)
+        {
+            return false;
+        }
+        mSlots[vWrite & mMask] = aCommand;
+        mWrite.store(vWrite + 1, std::memory_order_release);
+        return true;
+    }
+
+    //Consumer side, returns false if the queue is empty
+    bool Pop(T& aCommand)
+    {
+        const std::size_t vRead = mRead.load(std::memory_order_relaxed);
+        if (vRead == mWrite.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        aCommand = mSlots[vRead & mMask];
+        mRead.store(vRead + 1, std::memory_order_release);
+        return true;
+    }
+
+    //Producer side, pushes as many of the aCount items as fit and returns how many
+    std::size_t Push(const T* apCommands, std::size_t aCount)
+    {
+        const std::size_t vWrite = mWrite.load(std::memory_order_relaxed);
+        const std::size_t vFree = mSlots.size() - (vWrite - mRead.load(std::memory_order_acquire));
+        const std::size_t vCount = std::min(aCount, vFree);
+        for (std::size_t i = 0; i < vCount; ++i)
+        {
+            mSlots[(vWrite + i) & mMask] = apCommands[i];
+        }
+        mWrite.store(vWrite + vCount, std::memory_order_release);
+        return vCount;
+    }
+
+    //Consumer side, pops at most aCount items, or drops them if apCommands is
+    //null, and returns how many
+    std::size_t Pop(T* apCommands, std::size_t aCount)
+    {
+        const std::size_t vRead = mRead.load(std::memory_order_relaxed);
+        const std::size_t vCount = std::min(aCount, mWrite.load(std::memory_order_acquire) - vRead);
+        if (apCommands)
+        {
+            for (std::size_t i = 0; i < vCount; ++i)
+            {
+                apCommands[i] = mSlots[(vRead + i) & mMask];
+            }
+        }
+        mRead.store(vRead + vCount, std::memory_order_release);
+        return vCount;
+    }
+
+    std::size_t GetCapacity() const { return mSlots.size(); }
+
+    //Items in the queue, exact only on the consumer side
+    std::size_t GetSize() const { return mWrite.load(std::memory_order_acquire) - mRead.load(std::memory_order_acquire); }
+
+private:
+    std::vector<T> mSlots;
+    std::size_t mMask{ 0 };
+
+    //Free running counters, on separate cache lines to avoid false sharing
+    alignas(64) std::atomic<std::size_t> mWrite{ 0 };
+    alignas(64) std::atomic<std::size_t> mRead{ 0 };
+};
@@ -9,35 +9,24 @@
 */
 
 #pragma once
+#include <string>
 #include "../eigen/Eigen/Eigen"
 #define RUN_ALL  // define this macro if you want to run all methods (reference, optimised matrix and optimised vector)
 #define TIME_DOMAIN_STRING 0
+#define PARALLEL_VOICES 1 // render the MIDI voices on worker threads, one per extra core, see ModalVoicePool
+#define PIPELINED_VOICES 0 // render the MIDI voices one block ahead on a background thread, adding one block of latency, see ModalVoicePipeline
 
 namespace Global
 {
+    inline constexpr double kPi = 3.14159265358979323846;
+
     namespace Strings
     {
-        static struct String
+        //Physical parameters of the built-in strings, known at compile time
+        struct StringParams
         {
-            String(int aId,
-                juce::String aName,
-                float aRadius,
-                float aDensity, 
-                float aTension, 
-                float aYoungMod, 
-                float aLength)
-            {
-                mId = aId;
-                mName = aName;
-                mRadius = aRadius;
-                mDensity = aDensity;
-                mTension = aTension;
-                mYoungMod = aYoungMod;
-                mLength = aLength;
-            }
-
             int mId;
-            juce::String mName;
+            const char* mName;
             float mRadius;
             float mDensity;
             float mTension;
@@ -45,37 +34,81 @@ namespace Global
             float mLength;
         };
 
-        static String* kpCelloA3 = new String(1,
+        inline constexpr StringParams kCelloA3Params{ 1,
             "CelloA3",
             (float)3.75e-04,
-            (float)3.7575e3, 
-            153.f, 
-            (float)25e9, 
-            0.69f);
-        static String* kpCelloD3 = new String(2,
+            (float)3.7575e3,
+            153.f,
+            (float)25e9,
+            0.69f };
+        inline constexpr StringParams kCelloD3Params{ 2,
             "CelloD3",
             (float)4.4e-04,
             (float)4.1104e3,
             102.6f,
             (float)25e9,
-            0.69f);
-        static String* kpCelloG2 = new String(3,
+            0.69f };
+        inline constexpr StringParams kCelloG2Params{ 3,
             "CelloG2",
             (float)6.05e-04,
             (float)5.3570e3,
             112.67f,
             (float)8.6e9,
-            0.69f);
-        static String* kpCelloC2 = new String(4,
+            0.69f };
+        inline constexpr StringParams kCelloC2Params{ 4,
             "CelloC2",
             (float)7.2e-04,
             (float)1.3017e4,
             172.74f,
             (float)22.4e9,
-            0.69f);
+            0.69f };
+
+        struct String
+        {
+            String(int aId,
+                std::string aName,
+                float aRadius,
+                float aDensity, 
+                float aTension, 
+                float aYoungMod, 
+                float aLength)
+            {
+                mId = aId;
+                mName = aName;
+                mRadius = aRadius;
+                mDensity = aDensity;
+                mTension = aTension;
+                mYoungMod = aYoungMod;
+                mLength = aLength;
+            }
+
+            String(const StringParams& aParams)
+                : String(aParams.mId,
+                    aParams.mName,
+                    aParams.mRadius,
+                    aParams.mDensity,
+                    aParams.mTension,
+                    aParams.mYoungMod,
+                    aParams.mLength)
+            {
+            }
+
+            int mId;
+            std::string mName;
+            float mRadius;
+            float mDensity;
+            float mTension;
+            float mYoungMod;
+            float mLength;
+        };
+
+        static String* kpCelloA3 = new String(kCelloA3Params);
+        static String* kpCelloD3 = new String(kCelloD3Params);
+        static String* kpCelloG2 = new String(kCelloG2Params);
+        static String* kpCelloC2 = new String(kCelloC2Params);
     }
     
-    static double cubicInterpolation (double* xVec, int l, double alpha)
+    inline double cubicInterpolation (double* xVec, int l, double alpha)
     {
         return xVec[l - 1] * (alpha * (alpha - 1) * (alpha - 2)) / -6.0
         + xVec[l] * ((alpha - 1) * (alpha + 1) * (alpha - 2)) / 2.0
@@ -83,7 +116,7 @@ namespace Global
         + xVec[l + 2] * (alpha * (alpha + 1) * (alpha - 1)) / 6.0;
     }
 
-    static void cubicExtrapolation (double* xVec, int l, double alpha, double val)
+    inline void cubicExtrapolation (double* xVec, int l, double alpha, double val)
     {
         xVec[l - 1] = xVec[l - 1] + val * (alpha * (alpha - 1) * (alpha - 2)) / -6.0;
         xVec[l] = xVec[l] + val * ((alpha - 1) * (alpha + 1) * (alpha - 2)) / 2.0;
@@ -92,7 +125,7 @@ namespace Global
 
     }
 
-    static float limitOutput (float x)
+    inline float limitOutput (float x)
     {
         if (x > 1.0)
             return 1.0;
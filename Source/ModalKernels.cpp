@@ -0,0 +1,145 @@
+/*
+  ==============================================================================
+
+    ModalKernels.cpp
+    Created: 17/10/2026
+
+  ==============================================================================
+*/
+
+#include "ModalKernelsImpl.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define MODAL_KERNELS_X86 1
+#else
+#define MODAL_KERNELS_X86 0
+#endif
+
+namespace ModalKernels
+{
+namespace
+{
+#if MODAL_KERNELS_X86 && defined(_MSC_VER) && !defined(__clang__)
+    //Returns true if all the aMask bits of register aRegister of cpuid leaf aLeaf are set
+    bool HasCpuidBits(int aLeaf, int aRegister, int aMask)
+    {
+        int vInfo[4];
+        __cpuidex(vInfo, aLeaf, 0);
+        return (vInfo[aRegister] & aMask) == aMask;
+    }
+
+    //The OS must save the vector registers on context switch, see XCR0
+    bool HasOsSupport(unsigned long long aXcr0Mask)
+    {
+        if (!HasCpuidBits(1, 2, 1 << 27))   //OSXSAVE
+        {
+            return false;
+        }
+        return (_xgetbv(0) & aXcr0Mask) == aXcr0Mask;
+    }
+#endif
+
+    bool CpuSupports(Isa aIsa)
+    {
+#if !MODAL_KERNELS_X86
+        return aIsa == Isa::Scalar;
+#elif defined(_MSC_VER) && !defined(__clang__)
+        switch (aIsa)
+        {
+        case Isa::Scalar:
+            return true;
+        case Isa::Sse2:
+            return HasCpuidBits(1, 3, 1 << 26);
+        case Isa::Avx2:
+            return HasOsSupport(0x6) && HasCpuidBits(1, 2, 1 << 12) && HasCpuidBits(7, 1, 1 << 5);
+        case Isa::Avx512:
+            return HasOsSupport(0xe6) && HasCpuidBits(7, 1, 1 << 16);
+        }
+        return false;
+#else
+        __builtin_cpu_init();
+        switch (aIsa)
+        {
+        case Isa::Scalar:
+            return true;
+        case Isa::Sse2:
+            return __builtin_cpu_supports("sse2");
+        case Isa::Avx2:
+            return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+        case Isa::Avx512:
+            return __builtin_cpu_supports("avx512f");
+        }
+        return false;
+#endif
+    }
+
+    const Kernel* GetCompiledKernel(Isa aIsa)
+    {
+        switch (aIsa)
+        {
+        case Isa::Scalar:
+            return GetScalarKernel();
+        case Isa::Sse2:
+            return GetSse2Kernel();
+        case Isa::Avx2:
+            return GetAvx2Kernel();
+        case Isa::Avx512:
+            return GetAvx512Kernel();
+        }
+        return nullptr;
+    }
+}
+
+    bool IsSupported(Isa aIsa)
+    {
+        return GetCompiledKernel(aIsa) != nullptr && CpuSupports(aIsa);
+    }
+
+    Isa GetBestSupportedIsa()
+    {
+        static const Isa kBestIsa = []()
+        {
+            const Isa kIsas[] = { Isa::Avx512, Isa::Avx2, Isa::Sse2 };
+            for (auto vIsa : kIsas)
+            {
+                if (IsSupported(vIsa))
+                {
+                    return vIsa;
+                }
+            }
+            return Isa::Scalar;
+        }();
+        return kBestIsa;
+    }
+
+    const char* GetIsaName(Isa aIsa)
+    {
+        switch (aIsa)
+        {
+        case Isa::Scalar:
+            return "Scalar";
+        case Isa::Sse2:
+            return "SSE2";
+        case Isa::Avx2:
+            return "AVX2";
+        case Isa::Avx512:
+            return "AVX-512";
+        }
+        return "Unknown";
+    }
+
+    const Kernel* GetKernel(Isa aIsa)
+    {
+        return IsSupported(aIsa) ? GetCompiledKernel(aIsa) : GetScalarKernel();
+    }
+
+    const Kernel* GetScalarKernel()
+    {
+        static const Kernel kKernel = KernelImpl<ScalarOps>::Make(Isa::Scalar);
+        return &kKernel;
+    }
+}
@@ -0,0 +1,249 @@
+/*
+  ==============================================================================
+
+    ModalKernels.h
+    Created: 17/10/2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+/*
+Per-mode loops of the modal stiff string update, compiled once for each
+instruction set. The ModalStiffStringProcessor picks the best kernel supported
+by the CPU at construction time, the scalar one is kept as the reference.
+*/
+namespace ModalKernels
+{
+    enum class Isa
+    {
+        Scalar = 0,
+        Sse2,
+        Avx2,
+        Avx512
+    };
+
+    /*
+    Per-sample update of each mode, with the 2x2 trapezoidal blocks folded by
+    ModalStringTables::PrecompileCoefficients (q displacement, p velocity,
+    w input mode, g = w / SchurComp, o output mode of each pickup):
+
+        u  = VelDispl * q + VelVel * p                      free response
+        f  = bow term after the rank-one Sherman-Morrison correction (scalar)
+        p' = u + g * f
+        q' = q + k/2 * (p + p')
+    */
+
+    /*
+    Most pickups read by one string. The output mode shapes of the pickups are
+    rows of the output mode array, mModesOutStride floats apart, and the
+    output of each pickup is accumulated while the states are written, so the
+    states are streamed once for any number of pickups.
+    */
+    constexpr int kMaxPickups = 8;
+
+    //Inputs and outputs of the free response
+    struct FreeResponseArgs
+    {
+        const float* mpModesIn;
+        const float* mpDispl;
+        const float* mpVel;
+
+        const float* mpVelDisplCoeffs;
+        const float* mpVelVelCoeffs;
+
+        float* mpFreeVel;
+
+        int mModesNumber;
+    };
+
+    //Inputs and outputs of the state write-back
+    struct WriteBackArgs
+    {
+        const float* mpModesIn;
+        const float* mpModesInSchur;
+        const float* mpModesOut;    //mPickupsNumber rows
+
+        const float* mpFreeVel;
+
+        float mBowTerm;         //f
+        float mHalfTimeStep;    //k/2
+
+        float* mpDispl;         //Updated in place
+        float* mpVel;           //Updated in place
+
+        int mModesNumber;
+        int mPickupsNumber;
+        int mModesOutStride;
+    };
+
+    /*
+    Inputs and outputs of the free decay, used when the bow is not in contact.
+    Each mode is then an independent damped oscillator, advanced by one output
+    sample with [q'; p'] = [M11, M12; M21, M22] * [q; p].
+    */
+    struct FreeDecayArgs
+    {
+        const float* mpModesOut;    //mPickupsNumber rows
+
+        const float* mpM11;
+        const float* mpM12;
+        const float* mpM21;
+        const float* mpM22;
+
+        float* mpDispl;         //Updated in place
+        float* mpVel;           //Updated in place
+
+        int mModesNumber;
+        int mPickupsNumber;
+        int mModesOutStride;
+    };
+
+    /*
+    Crossfade of the mode shapes from one block to the next, in place: each
+    step of mpRampWriteBack adds the steps to the mode shapes after updating
+    the velocities, so the projections it returns are those of the next step.
+    mpRampFreeDecay reads the output modes as those of its first sample and
+    adds the output step at each sample, without writing them back. The output
+    mode shapes and steps have the rows of the pickups, as in WriteBackArgs.
+    */
+    struct ModesRampArgs
+    {
+        float* mpModesIn;
+        float* mpModesInSchur;
+        float* mpModesOut;
+
+        const float* mpModesInStep;
+        const float* mpModesInSchurStep;
+        const float* mpModesOutStep;
+    };
+
+    /*
+    Bow moving along the string at each step of mpRotateWriteBack. The input
+    mode shapes w = S * sin(n * theta) turn by the angle n * delta of each mode
+    together with their quadrature c = S * cos(n * theta), in place:
+        w' = w * cos(n * delta) + c * sin(n * delta)
+        c' = c * cos(n * delta) - w * sin(n * delta)
+        g' = w' / SchurComp
+    The output mode shapes step as in ModesRampArgs, with zero steps if they
+    are not crossfading.
+    */
+    struct ModesRotationArgs
+    {
+        float* mpModesIn;
+        float* mpModesInQuad;
+        float* mpModesInSchur;
+        float* mpModesOut;
+
+        const float* mpRotationCos;
+        const float* mpRotationSin;
+        const float* mpInvSchurComp;
+        const float* mpModesOutStep;
+    };
+
+    /*
+    Inputs and outputs of the bow friction terms of mCount independent contacts,
+    e.g. one per voice, with eta the relative velocity of bow and string:
+        d = sqrt(2a) * exp(-a * eta^2 + 1/2),   lambda = d * (1 - 2a * eta^2)
+    The exponential is a polynomial approximation, see BowFriction.h.
+    */
+    struct FrictionArgs
+    {
+        float mA;
+        float mSqrt2A;
+
+        const float* mpEta;
+        float* mpD;
+        float* mpLambda;
+
+        int mCount;
+    };
+
+    /*
+    The batch kernels advance kBatchLanes independent strings at once, one per
+    lane, with their per-mode arrays interleaved: the value of lane l for mode m
+    is at [m * kBatchLanes + l]. Every per-lane quantity, the reductions over
+    the modes included, stays in its lane, so no horizontal sum is needed.
+    The free response of the batch takes the FreeResponseArgs above with
+    interleaved arrays.
+    */
+    constexpr int kBatchLanes = 16;
+
+    //Inputs and outputs of the state write-back of a batch
+    struct BatchWriteBackArgs
+    {
+        const float* mpModesIn;
+        const float* mpModesInSchur;
+        const float* mpModesOut;
+
+        const float* mpFreeVel;
+
+        const float* mpBowTerms;    //f of each lane
+        float mHalfTimeStep;        //k/2
+
+        float* mpDispl;             //Updated in place
+        float* mpVel;               //Updated in place
+
+        int mModesNumber;
+    };
+
+    struct Kernel
+    {
+        Isa mIsa;
+
+        //Returns sum(apModesIn[i] * apVelocities[i])
+        float (*mpInputProjection)(const float* apModesIn, const float* apVelocities, int aModesNumber);
+
+        //Fills the free response u and returns its input projection sum(w * u)
+        float (*mpFreeResponse)(const FreeResponseArgs& aArgs);
+
+        //Writes the new states, returning the input projection of the new
+        //velocities and the output projection of the new displacements of
+        //each pickup in apOutputs
+        void (*mpWriteBack)(const WriteBackArgs& aArgs, float& aZeta1, float* apOutputs);
+
+        //Advances the states by aNumSamples, writing the output projection of
+        //each sample in apOutputs[k] for each pickup k
+        void (*mpFreeDecay)(const FreeDecayArgs& aArgs, float* const* apOutputs, int aNumSamples);
+
+        //Returns the modal energy sum((apEigenFreqs[i] * apDispl[i])^2 + apVel[i]^2) / 2
+        float (*mpEnergy)(const float* apEigenFreqs, const float* apDispl, const float* apVel, int aModesNumber);
+
+        //Writes the friction terms d and lambda of each contact
+        void (*mpFriction)(const FrictionArgs& aArgs);
+
+        //Versions of mpWriteBack and mpFreeDecay crossfading the mode shapes,
+        //the mode shapes of aArgs are ignored
+        void (*mpRampWriteBack)(const WriteBackArgs& aArgs, const ModesRampArgs& aRamp, float& aZeta1, float* apOutputs);
+        void (*mpRampFreeDecay)(const FreeDecayArgs& aArgs, const ModesRampArgs& aRamp, float* const* apOutputs, int aNumSamples);
+
+        //Version of mpWriteBack moving the bow, also returning the new
+        //sum(w * g) of the next step, the mode shapes of aArgs are ignored
+        void (*mpRotateWriteBack)(const WriteBackArgs& aArgs, const ModesRotationArgs& aRotation,
+            float& aZeta1, float& aInSchurProjection, float* apOutputs);
+
+        //Batch versions of the functions above, writing one result per lane in
+        //arrays of kBatchLanes floats
+        void (*mpBatchInputProjection)(const float* apModesIn, const float* apVelocities, int aModesNumber, float* apProjections);
+        void (*mpBatchFreeResponse)(const FreeResponseArgs& aArgs, float* apProjections);
+        void (*mpBatchWriteBack)(const BatchWriteBackArgs& aArgs, float* apZeta1, float* apOutputs);
+    };
+
+    //Returns true if the kernel for aIsa has been compiled and the CPU runs it
+    bool IsSupported(Isa aIsa);
+
+    //Returns the widest instruction set for which IsSupported() is true
+    Isa GetBestSupportedIsa();
+
+    const char* GetIsaName(Isa aIsa);
+
+    //Returns the kernel for aIsa, or the scalar one if aIsa is not supported
+    const Kernel* GetKernel(Isa aIsa);
+
+    //Kernel tables, nullptr if the instruction set is not available in the build
+    const Kernel* GetScalarKernel();
+    const Kernel* GetSse2Kernel();
+    const Kernel* GetAvx2Kernel();
+    const Kernel* GetAvx512Kernel();
+}
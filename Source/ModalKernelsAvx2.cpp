@@ -0,0 +1,64 @@
+/*
+  ==============================================================================
+
+    ModalKernelsAvx2.cpp
+    Created: 17/10/2026
+
+    Needs AVX2 and FMA code generation for this file only (-mavx2 -mfma),
+    otherwise the kernel is left out of the build. MSVC accepts the
+    intrinsics without any flag.
+
+  ==============================================================================
+*/
+
+#include "ModalKernelsImpl.h"
+
+#if (defined(__AVX2__) && defined(__FMA__)) || (defined(_MSC_VER) && !defined(__clang__) && (defined(_M_X64) || defined(_M_IX86)))
+#define MODAL_KERNELS_AVX2 1
+#include <immintrin.h>
+#else
+#define MODAL_KERNELS_AVX2 0
+#endif
+
+namespace ModalKernels
+{
+#if MODAL_KERNELS_AVX2
+namespace
+{
+    struct Avx2Ops
+    {
+        using Vec = __m256;
+        static constexpr int kWidth = 8;
+
+        static inline Vec Load(const float* apSrc) { return _mm256_loadu_ps(apSrc); }
+        static inline void Store(float* apDst, Vec aV) { _mm256_storeu_ps(apDst, aV); }
+        static inline Vec Set(float aV) { return _mm256_set1_ps(aV); }
+        static inline Vec Add(Vec aA, Vec aB) { return _mm256_add_ps(aA, aB); }
+        static inline Vec Sub(Vec aA, Vec aB) { return _mm256_sub_ps(aA, aB); }
+        static inline Vec Mul(Vec aA, Vec aB) { return _mm256_mul_ps(aA, aB); }
+        static inline Vec MulAdd(Vec aA, Vec aB, Vec aC) { return _mm256_fmadd_ps(aA, aB, aC); }
+        static inline Vec Max(Vec aA, Vec aB) { return _mm256_max_ps(aA, aB); }
+        static inline Vec Round(Vec aV) { return _mm256_round_ps(aV, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+        static inline Vec Pow2(Vec aN) { return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(aN), _mm256_set1_epi32(127)), 23)); }
+        static inline float Sum(Vec aV)
+        {
+            __m128 vSum = _mm_add_ps(_mm256_castps256_ps128(aV), _mm256_extractf128_ps(aV, 1));
+            vSum = _mm_add_ps(vSum, _mm_movehl_ps(vSum, vSum));
+            vSum = _mm_add_ss(vSum, _mm_shuffle_ps(vSum, vSum, 0x55));
+            return _mm_cvtss_f32(vSum);
+        }
+    };
+}
+
+    const Kernel* GetAvx2Kernel()
+    {
+        static const Kernel kKernel = KernelImpl<Avx2Ops>::Make(Isa::Avx2);
+        return &kKernel;
+    }
+#else
+    const Kernel* GetAvx2Kernel()
+    {
+        return nullptr;
+    }
+#endif
+}
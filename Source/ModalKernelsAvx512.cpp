@@ -0,0 +1,75 @@
+/*
+  ==============================================================================
+
+    ModalKernelsAvx512.cpp
+    Created: 17/10/2026
+
+    Needs AVX-512F code generation for this file only (-mavx512f),
+    otherwise the kernel is left out of the build. MSVC accepts the
+    intrinsics without any flag.
+
+  ==============================================================================
+*/
+
+#include "ModalKernelsImpl.h"
+
+#if defined(__AVX512F__) || (defined(_MSC_VER) && !defined(__clang__) && defined(_M_X64))
+#define MODAL_KERNELS_AVX512 1
+#include <immintrin.h>
+#else
+#define MODAL_KERNELS_AVX512 0
+#endif
+
+namespace ModalKernels
+{
+#if MODAL_KERNELS_AVX512
+namespace
+{
+    struct Avx512Ops
+    {
+        using Vec = __m512;
+        static constexpr int kWidth = 16;
+
+        static inline Vec Load(const float* apSrc) { return _mm512_loadu_ps(apSrc); }
+        static inline void Store(float* apDst, Vec aV) { _mm512_storeu_ps(apDst, aV); }
+        static inline Vec Set(float aV) { return _mm512_set1_ps(aV); }
+        static inline Vec Add(Vec aA, Vec aB) { return _mm512_add_ps(aA, aB); }
+        static inline Vec Sub(Vec aA, Vec aB) { return _mm512_sub_ps(aA, aB); }
+        static inline Vec Mul(Vec aA, Vec aB) { return _mm512_mul_ps(aA, aB); }
+        static inline Vec MulAdd(Vec aA, Vec aB, Vec aC) { return _mm512_fmadd_ps(aA, aB, aC); }
+        //Zero masked forms, the unmasked ones of some GCC versions trigger -Wmaybe-uninitialized
+        static inline Vec Max(Vec aA, Vec aB) { return _mm512_maskz_max_ps(0xffff, aA, aB); }
+        static inline Vec Round(Vec aV) { return _mm512_maskz_roundscale_ps(0xffff, aV, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+        static inline Vec Pow2(Vec aN)
+        {
+            __m512i vExponent = _mm512_add_epi32(_mm512_maskz_cvtps_epi32(0xffff, aN), _mm512_set1_epi32(127));
+            return _mm512_castsi512_ps(_mm512_maskz_slli_epi32(0xffff, vExponent, 23));
+        }
+        static inline float Sum(Vec aV)
+        {
+            //Folding the 128-bit lanes on the first one
+            Vec vFolded = _mm512_add_ps(aV, _mm512_maskz_shuffle_f32x4(0xffff, aV, aV, 0xee));
+            vFolded = _mm512_add_ps(vFolded, _mm512_maskz_shuffle_f32x4(0xffff, vFolded, vFolded, 0x01));
+            //The 512 to 128-bit casts of some GCC versions trigger -Wuninitialized
+            alignas(64) float vLanes[16];
+            _mm512_store_ps(vLanes, vFolded);
+            __m128 vSum = _mm_load_ps(vLanes);
+            vSum = _mm_add_ps(vSum, _mm_movehl_ps(vSum, vSum));
+            vSum = _mm_add_ss(vSum, _mm_shuffle_ps(vSum, vSum, 0x55));
+            return _mm_cvtss_f32(vSum);
+        }
+    };
+}
+
+    const Kernel* GetAvx512Kernel()
+    {
+        static const Kernel kKernel = KernelImpl<Avx512Ops>::Make(Isa::Avx512);
+        return &kKernel;
+    }
+#else
+    const Kernel* GetAvx512Kernel()
+    {
+        return nullptr;
+    }
+#endif
+}
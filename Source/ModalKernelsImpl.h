@@ -0,0 +1,588 @@
+/*
+  ==============================================================================
+
+    ModalKernelsImpl.h
+    Created: 17/10/2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include "ModalKernels.h"
+
+/*
+Generic body of the modal kernels, included by each ModalKernels<Isa>.cpp and
+instantiated with the operations of that instruction set. Everything is kept in
+an anonymous namespace, so that code compiled with different target flags in
+different translation units is never merged by the linker. For the same reason
+no standard library function is called from here.
+
+An operations class provides:
+    Vec, kWidth, Load, Store, Set, Add, Sub, Mul, MulAdd (a * b + c), Sum,
+    Max, Round (to the nearest integer), Pow2 (2^n for integer n in [-126, 127])
+*/
+namespace ModalKernels
+{
+namespace
+{
+    struct ScalarOps
+    {
+        using Vec = float;
+        static constexpr int kWidth = 1;
+
+        static inline Vec Load(const float* apSrc) { return *apSrc; }
+        static inline void Store(float* apDst, Vec aV) { *apDst = aV; }
+        static inline Vec Set(float aV) { return aV; }
+        static inline Vec Add(Vec aA, Vec aB) { return aA + aB; }
+        static inline Vec Sub(Vec aA, Vec aB) { return aA - aB; }
+        static inline Vec Mul(Vec aA, Vec aB) { return aA * aB; }
+        static inline Vec MulAdd(Vec aA, Vec aB, Vec aC) { return aA * aB + aC; }
+        static inline float Sum(Vec aV) { return aV; }
+        static inline Vec Max(Vec aA, Vec aB) { return aA > aB ? aA : aB; }
+        static inline Vec Round(Vec aV) { return static_cast<float>(static_cast<int>(aV < 0.f ? aV - 0.5f : aV + 0.5f)); }
+        static inline Vec Pow2(Vec aN)
+        {
+            union { int mBits; float mValue; } vPow2;
+            vPow2.mBits = (static_cast<int>(aN) + 127) << 23;
+            return vPow2.mValue;
+        }
+    };
+
+    //Number of pickups as a type, so that the per-pickup loops are unrolled
+    template <int K>
+    struct Pickups
+    {
+        static constexpr int kNumber = K;
+    };
+
+    //Calls aFunction with Pickups<aPickupsNumber>, from 1 to kMaxPickups
+    template <class F>
+    static inline void DispatchPickups(int aPickupsNumber, F aFunction)
+    {
+        static_assert(kMaxPickups == 8, "One case per number of pickups");
+        switch (aPickupsNumber)
+        {
+        case 1: aFunction(Pickups<1>()); break;
+        case 2: aFunction(Pickups<2>()); break;
+        case 3: aFunction(Pickups<3>()); break;
+        case 4: aFunction(Pickups<4>()); break;
+        case 5: aFunction(Pickups<5>()); break;
+        case 6: aFunction(Pickups<6>()); break;
+        case 7: aFunction(Pickups<7>()); break;
+        case 8: aFunction(Pickups<8>()); break;
+        default: break;
+        }
+    }
+
+    template <class Ops>
+    struct KernelImpl
+    {
+        template <class O>
+        static inline void FreeResponseLanes(const FreeResponseArgs& aArgs, int i, typename O::Vec& aProjection)
+        {
+            using Vec = typename O::Vec;
+
+            Vec vFreeVel = O::MulAdd(O::Load(aArgs.mpVelDisplCoeffs + i), O::Load(aArgs.mpDispl + i),
+                O::Mul(O::Load(aArgs.mpVelVelCoeffs + i), O::Load(aArgs.mpVel + i)));
+            O::Store(aArgs.mpFreeVel + i, vFreeVel);
+
+            aProjection = O::MulAdd(O::Load(aArgs.mpModesIn + i), vFreeVel, aProjection);
+        }
+
+        //Adds the output projection of the displacements aDispl to each of the K pickups
+        template <class O, int K>
+        static inline void OutputLanes(const float* apModesOut, int aModesOutStride, int i, typename O::Vec aDispl, typename O::Vec* apOutputs)
+        {
+            for (int k = 0; k < K; ++k)
+            {
+                apOutputs[k] = O::MulAdd(O::Load(apModesOut + k * aModesOutStride + i), aDispl, apOutputs[k]);
+            }
+        }
+
+        template <class O, int K>
+        static inline void WriteBackLanes(const WriteBackArgs& aArgs, int i, typename O::Vec& aZeta1, typename O::Vec* apOutputs)
+        {
+            using Vec = typename O::Vec;
+
+            Vec vVel = O::Load(aArgs.mpVel + i);
+            Vec vNextVel = O::MulAdd(O::Load(aArgs.mpModesInSchur + i), O::Set(aArgs.mBowTerm), O::Load(aArgs.mpFreeVel + i));
+            Vec vNextDispl = O::MulAdd(O::Set(aArgs.mHalfTimeStep), O::Add(vVel, vNextVel), O::Load(aArgs.mpDispl + i));
+            O::Store(aArgs.mpDispl + i, vNextDispl);
+            O::Store(aArgs.mpVel + i, vNextVel);
+
+            aZeta1 = O::MulAdd(O::Load(aArgs.mpModesIn + i), vNextVel, aZeta1);
+            OutputLanes<O, K>(aArgs.mpModesOut, aArgs.mModesOutStride, i, vNextDispl, apOutputs);
+        }
+
+        //Steps the output mode shapes of the K pickups and adds their projection
+        template <class O, int K>
+        static inline void RampOutputLanes(float* apModesOut, const float* apModesOutStep, int aModesOutStride, int i,
+            typename O::Vec aDispl, typename O::Vec* apOutputs)
+        {
+            for (int k = 0; k < K; ++k)
+            {
+                int j = k * aModesOutStride + i;
+                typename O::Vec vNextModeOut = O::Add(O::Load(apModesOut + j), O::Load(apModesOutStep + j));
+                O::Store(apModesOut + j, vNextModeOut);
+                apOutputs[k] = O::MulAdd(vNextModeOut, aDispl, apOutputs[k]);
+            }
+        }
+
+        template <class O, int K>
+        static inline void RampWriteBackLanes(const WriteBackArgs& aArgs, const ModesRampArgs& aRamp, int i, typename O::Vec& aZeta1, typename O::Vec* apOutputs)
+        {
+            using Vec = typename O::Vec;
+
+            Vec vVel = O::Load(aArgs.mpVel + i);
+            Vec vModeInSchur = O::Load(aRamp.mpModesInSchur + i);
+            Vec vNextVel = O::MulAdd(vModeInSchur, O::Set(aArgs.mBowTerm), O::Load(aArgs.mpFreeVel + i));
+            Vec vNextDispl = O::MulAdd(O::Set(aArgs.mHalfTimeStep), O::Add(vVel, vNextVel), O::Load(aArgs.mpDispl + i));
+            O::Store(aArgs.mpDispl + i, vNextDispl);
+            O::Store(aArgs.mpVel + i, vNextVel);
+
+            Vec vNextModeIn = O::Add(O::Load(aRamp.mpModesIn + i), O::Load(aRamp.mpModesInStep + i));
+            O::Store(aRamp.mpModesIn + i, vNextModeIn);
+            O::Store(aRamp.mpModesInSchur + i, O::Add(vModeInSchur, O::Load(aRamp.mpModesInSchurStep + i)));
+
+            aZeta1 = O::MulAdd(vNextModeIn, vNextVel, aZeta1);
+            RampOutputLanes<O, K>(aRamp.mpModesOut, aRamp.mpModesOutStep, aArgs.mModesOutStride, i, vNextDispl, apOutputs);
+        }
+
+        template <class O, int K>
+        static inline void RotateWriteBackLanes(const WriteBackArgs& aArgs, const ModesRotationArgs& aRotation, int i,
+            typename O::Vec& aZeta1, typename O::Vec& aProjection, typename O::Vec* apOutputs)
+        {
+            using Vec = typename O::Vec;
+
+            Vec vVel = O::Load(aArgs.mpVel + i);
+            Vec vNextVel = O::MulAdd(O::Load(aRotation.mpModesInSchur + i), O::Set(aArgs.mBowTerm), O::Load(aArgs.mpFreeVel + i));
+            Vec vNextDispl = O::MulAdd(O::Set(aArgs.mHalfTimeStep), O::Add(vVel, vNextVel), O::Load(aArgs.mpDispl + i));
+            O::Store(aArgs.mpDispl + i, vNextDispl);
+            O::Store(aArgs.mpVel + i, vNextVel);
+
+            Vec vModeIn = O::Load(aRotation.mpModesIn + i);
+            Vec vModeInQuad = O::Load(aRotation.mpModesInQuad + i);
+            Vec vCos = O::Load(aRotation.mpRotationCos + i);
+            Vec vSin = O::Load(aRotation.mpRotationSin + i);
+            Vec vNextModeIn = O::MulAdd(vModeIn, vCos, O::Mul(vModeInQuad, vSin));
+            Vec vNextModeInQuad = O::Sub(O::Mul(vModeInQuad, vCos), O::Mul(vModeIn, vSin));
+            Vec vNextModeInSchur = O::Mul(vNextModeIn, O::Load(aRotation.mpInvSchurComp + i));
+            O::Store(aRotation.mpModesIn + i, vNextModeIn);
+            O::Store(aRotation.mpModesInQuad + i, vNextModeInQuad);
+            O::Store(aRotation.mpModesInSchur + i, vNextModeInSchur);
+
+            aZeta1 = O::MulAdd(vNextModeIn, vNextVel, aZeta1);
+            aProjection = O::MulAdd(vNextModeIn, vNextModeInSchur, aProjection);
+            RampOutputLanes<O, K>(aRotation.mpModesOut, aRotation.mpModesOutStep, aArgs.mModesOutStride, i, vNextDispl, apOutputs);
+        }
+
+        static float InputProjection(const float* apModesIn, const float* apVelocities, int aModesNumber)
+        {
+            typename Ops::Vec vAcc = Ops::Set(0.f);
+            int i = 0;
+            for (; i + Ops::kWidth <= aModesNumber; i += Ops::kWidth)
+            {
+                vAcc = Ops::MulAdd(Ops::Load(apModesIn + i), Ops::Load(apVelocities + i), vAcc);
+            }
+            float vZeta1 = Ops::Sum(vAcc);
+            for (; i < aModesNumber; ++i)
+            {
+                vZeta1 += apModesIn[i] * apVelocities[i];
+            }
+            return vZeta1;
+        }
+
+        static float FreeResponse(const FreeResponseArgs& aArgs)
+        {
+            typename Ops::Vec vProjection = Ops::Set(0.f);
+            int i = 0;
+            for (; i + Ops::kWidth <= aArgs.mModesNumber; i += Ops::kWidth)
+            {
+                FreeResponseLanes<Ops>(aArgs, i, vProjection);
+            }
+            float vTailProjection = 0.f;
+            for (; i < aArgs.mModesNumber; ++i)
+            {
+                FreeResponseLanes<ScalarOps>(aArgs, i, vTailProjection);
+            }
+            return Ops::Sum(vProjection) + vTailProjection;
+        }
+
+        static void WriteBack(const WriteBackArgs& aArgs, float& aZeta1, float* apOutputs)
+        {
+            DispatchPickups(aArgs.mPickupsNumber, [&](auto aPickups)
+            {
+                constexpr int K = decltype(aPickups)::kNumber;
+                typename Ops::Vec vZeta1 = Ops::Set(0.f);
+                typename Ops::Vec vOutputs[K];
+                float vTailZeta1 = 0.f;
+                float vTailOutputs[K];
+                for (int k = 0; k < K; ++k)
+                {
+                    vOutputs[k] = Ops::Set(0.f);
+                    vTailOutputs[k] = 0.f;
+                }
+                int i = 0;
+                for (; i + Ops::kWidth <= aArgs.mModesNumber; i += Ops::kWidth)
+                {
+                    WriteBackLanes<Ops, K>(aArgs, i, vZeta1, vOutputs);
+                }
+                for (; i < aArgs.mModesNumber; ++i)
+                {
+                    WriteBackLanes<ScalarOps, K>(aArgs, i, vTailZeta1, vTailOutputs);
+                }
+                aZeta1 = Ops::Sum(vZeta1) + vTailZeta1;
+                for (int k = 0; k < K; ++k)
+                {
+                    apOutputs[k] = Ops::Sum(vOutputs[k]) + vTailOutputs[k];
+                }
+            });
+        }
+
+        static void RampWriteBack(const WriteBackArgs& aArgs, const ModesRampArgs& aRamp, float& aZeta1, float* apOutputs)
+        {
+            DispatchPickups(aArgs.mPickupsNumber, [&](auto aPickups)
+            {
+                constexpr int K = decltype(aPickups)::kNumber;
+                typename Ops::Vec vZeta1 = Ops::Set(0.f);
+                typename Ops::Vec vOutputs[K];
+                float vTailZeta1 = 0.f;
+                float vTailOutputs[K];
+                for (int k = 0; k < K; ++k)
+                {
+                    vOutputs[k] = Ops::Set(0.f);
+                    vTailOutputs[k] = 0.f;
+                }
+                int i = 0;
+                for (; i + Ops::kWidth <= aArgs.mModesNumber; i += Ops::kWidth)
+                {
+                    RampWriteBackLanes<Ops, K>(aArgs, aRamp, i, vZeta1, vOutputs);
+                }
+                for (; i < aArgs.mModesNumber; ++i)
+                {
+                    RampWriteBackLanes<ScalarOps, K>(aArgs, aRamp, i, vTailZeta1, vTailOutputs);
+                }
+                aZeta1 = Ops::Sum(vZeta1) + vTailZeta1;
+                for (int k = 0; k < K; ++k)
+                {
+                    apOutputs[k] = Ops::Sum(vOutputs[k]) + vTailOutputs[k];
+                }
+            });
+        }
+
+        static void RotateWriteBack(const WriteBackArgs& aArgs, const ModesRotationArgs& aRotation,
+            float& aZeta1, float& aInSchurProjection, float* apOutputs)
+        {
+            DispatchPickups(aArgs.mPickupsNumber, [&](auto aPickups)
+            {
+                constexpr int K = decltype(aPickups)::kNumber;
+                typename Ops::Vec vZeta1 = Ops::Set(0.f);
+                typename Ops::Vec vProjection = Ops::Set(0.f);
+                typename Ops::Vec vOutputs[K];
+                float vTailZeta1 = 0.f;
+                float vTailProjection = 0.f;
+                float vTailOutputs[K];
+                for (int k = 0; k < K; ++k)
+                {
+                    vOutputs[k] = Ops::Set(0.f);
+                    vTailOutputs[k] = 0.f;
+                }
+                int i = 0;
+                for (; i + Ops::kWidth <= aArgs.mModesNumber; i += Ops::kWidth)
+                {
+                    RotateWriteBackLanes<Ops, K>(aArgs, aRotation, i, vZeta1, vProjection, vOutputs);
+                }
+                for (; i < aArgs.mModesNumber; ++i)
+                {
+                    RotateWriteBackLanes<ScalarOps, K>(aArgs, aRotation, i, vTailZeta1, vTailProjection, vTailOutputs);
+                }
+                aZeta1 = Ops::Sum(vZeta1) + vTailZeta1;
+                aInSchurProjection = Ops::Sum(vProjection) + vTailProjection;
+                for (int k = 0; k < K; ++k)
+                {
+                    apOutputs[k] = Ops::Sum(vOutputs[k]) + vTailOutputs[k];
+                }
+            });
+        }
+
+        //Outputs accumulated for each load of the states in FreeDecay, i.e.
+        //kFreeDecayChunk / K samples of K pickups
+        static constexpr int kFreeDecayChunk = 64;
+
+        //Without apModesOutStep the output modes are constant, otherwise they
+        //start at the output modes plus aStart steps. The output of the pickup
+        //k at the sample n is accumulated in apOutputs[n * K + k]
+        template <class O, int K>
+        static inline void FreeDecayLanes(const FreeDecayArgs& aArgs, const float* apModesOutStep, int aStart,
+            int i, typename O::Vec* apOutputs, int aNumSamples)
+        {
+            using Vec = typename O::Vec;
+
+            Vec vM11 = O::Load(aArgs.mpM11 + i);
+            Vec vM12 = O::Load(aArgs.mpM12 + i);
+            Vec vM21 = O::Load(aArgs.mpM21 + i);
+            Vec vM22 = O::Load(aArgs.mpM22 + i);
+            Vec vDispl = O::Load(aArgs.mpDispl + i);
+            Vec vVel = O::Load(aArgs.mpVel + i);
+            Vec vModesOut[K];
+            for (int k = 0; k < K; ++k)
+            {
+                vModesOut[k] = O::Load(aArgs.mpModesOut + k * aArgs.mModesOutStride + i);
+            }
+
+            if (apModesOutStep)
+            {
+                Vec vModesOutStep[K];
+                for (int k = 0; k < K; ++k)
+                {
+                    vModesOutStep[k] = O::Load(apModesOutStep + k * aArgs.mModesOutStride + i);
+                    vModesOut[k] = O::MulAdd(O::Set(static_cast<float>(aStart)), vModesOutStep[k], vModesOut[k]);
+                }
+                for (int n = 0; n < aNumSamples; ++n)
+                {
+                    Vec vNextDispl = O::MulAdd(vM11, vDispl, O::Mul(vM12, vVel));
+                    vVel = O::MulAdd(vM21, vDispl, O::Mul(vM22, vVel));
+                    vDispl = vNextDispl;
+                    for (int k = 0; k < K; ++k)
+                    {
+                        vModesOut[k] = O::Add(vModesOut[k], vModesOutStep[k]);
+                        apOutputs[n * K + k] = O::MulAdd(vModesOut[k], vDispl, apOutputs[n * K + k]);
+                    }
+                }
+            }
+            else
+            {
+                for (int n = 0; n < aNumSamples; ++n)
+                {
+                    Vec vNextDispl = O::MulAdd(vM11, vDispl, O::Mul(vM12, vVel));
+                    vVel = O::MulAdd(vM21, vDispl, O::Mul(vM22, vVel));
+                    vDispl = vNextDispl;
+                    for (int k = 0; k < K; ++k)
+                    {
+                        apOutputs[n * K + k] = O::MulAdd(vModesOut[k], vDispl, apOutputs[n * K + k]);
+                    }
+                }
+            }
+
+            O::Store(aArgs.mpDispl + i, vDispl);
+            O::Store(aArgs.mpVel + i, vVel);
+        }
+
+        static void FreeDecay(const FreeDecayArgs& aArgs, float* const* apOutputs, int aNumSamples)
+        {
+            FreeDecayChunks(aArgs, nullptr, apOutputs, aNumSamples);
+        }
+
+        static void RampFreeDecay(const FreeDecayArgs& aArgs, const ModesRampArgs& aRamp, float* const* apOutputs, int aNumSamples)
+        {
+            FreeDecayArgs vArgs = aArgs;
+            vArgs.mpModesOut = aRamp.mpModesOut;
+            FreeDecayChunks(vArgs, aRamp.mpModesOutStep, apOutputs, aNumSamples);
+        }
+
+        static void FreeDecayChunks(const FreeDecayArgs& aArgs, const float* apModesOutStep, float* const* apOutputs, int aNumSamples)
+        {
+            DispatchPickups(aArgs.mPickupsNumber, [&](auto aPickups)
+            {
+                constexpr int K = decltype(aPickups)::kNumber;
+                constexpr int kChunk = kFreeDecayChunk / K;
+
+                //Modes are the outer loop, so that each state is loaded once per chunk
+                //and the outputs are accumulated lane by lane
+                typename Ops::Vec vOutputs[kChunk * K];
+                float vTailOutputs[kChunk * K];
+                for (int vStart = 0; vStart < aNumSamples; vStart += kChunk)
+                {
+                    int vNumSamples = aNumSamples - vStart < kChunk ? aNumSamples - vStart : kChunk;
+                    for (int j = 0; j < vNumSamples * K; ++j)
+                    {
+                        vOutputs[j] = Ops::Set(0.f);
+                        vTailOutputs[j] = 0.f;
+                    }
+
+                    int i = 0;
+                    for (; i + Ops::kWidth <= aArgs.mModesNumber; i += Ops::kWidth)
+                    {
+                        FreeDecayLanes<Ops, K>(aArgs, apModesOutStep, vStart, i, vOutputs, vNumSamples);
+                    }
+                    for (; i < aArgs.mModesNumber; ++i)
+                    {
+                        FreeDecayLanes<ScalarOps, K>(aArgs, apModesOutStep, vStart, i, vTailOutputs, vNumSamples);
+                    }
+
+                    for (int n = 0; n < vNumSamples; ++n)
+                    {
+                        for (int k = 0; k < K; ++k)
+                        {
+                            apOutputs[k][vStart + n] = Ops::Sum(vOutputs[n * K + k]) + vTailOutputs[n * K + k];
+                        }
+                    }
+                }
+            });
+        }
+
+        template <class O>
+        static inline void EnergyLanes(const float* apEigenFreqs, const float* apDispl, const float* apVel, int i, typename O::Vec& aEnergy)
+        {
+            using Vec = typename O::Vec;
+
+            Vec vDisplTerm = O::Mul(O::Load(apEigenFreqs + i), O::Load(apDispl + i));
+            Vec vVel = O::Load(apVel + i);
+            aEnergy = O::MulAdd(vDisplTerm, vDisplTerm, O::MulAdd(vVel, vVel, aEnergy));
+        }
+
+        static float Energy(const float* apEigenFreqs, const float* apDispl, const float* apVel, int aModesNumber)
+        {
+            typename Ops::Vec vEnergy = Ops::Set(0.f);
+            int i = 0;
+            for (; i + Ops::kWidth <= aModesNumber; i += Ops::kWidth)
+            {
+                EnergyLanes<Ops>(apEigenFreqs, apDispl, apVel, i, vEnergy);
+            }
+            float vTailEnergy = 0.f;
+            for (; i < aModesNumber; ++i)
+            {
+                EnergyLanes<ScalarOps>(apEigenFreqs, apDispl, apVel, i, vTailEnergy);
+            }
+            return 0.5f * (Ops::Sum(vEnergy) + vTailEnergy);
+        }
+
+        //exp(aX) for aX <= 1, the relative error grows from 2e-7 with |aX| as the
+        //rounding of aX * log2(e) does, see BowFriction.h
+        template <class O>
+        static inline typename O::Vec Exp(typename O::Vec aX)
+        {
+            using Vec = typename O::Vec;
+
+            //exp(x) = 2^n * 2^f, with n the integer nearest to x * log2(e) and |f| <= 1/2.
+            //Below 2^-126 the result is flushed to about 1e-38
+            Vec vT = O::Max(O::Mul(aX, O::Set(1.44269504088896341f)), O::Set(-126.f));
+            Vec vN = O::Round(vT);
+            Vec vF = O::Sub(vT, vN);
+
+            //Minimax polynomial of 2^f on [-1/2, 1/2], from Cephes exp2f
+            Vec vPoly = O::Set(1.535336188319500e-4f);
+            vPoly = O::MulAdd(vPoly, vF, O::Set(1.339887440266574e-3f));
+            vPoly = O::MulAdd(vPoly, vF, O::Set(9.618437357674640e-3f));
+            vPoly = O::MulAdd(vPoly, vF, O::Set(5.550332471162809e-2f));
+            vPoly = O::MulAdd(vPoly, vF, O::Set(2.402264791363012e-1f));
+            vPoly = O::MulAdd(vPoly, vF, O::Set(6.931472028550421e-1f));
+            vPoly = O::MulAdd(vPoly, vF, O::Set(1.f));
+            return O::Mul(vPoly, O::Pow2(vN));
+        }
+
+        template <class O>
+        static inline void FrictionLanes(const FrictionArgs& aArgs, int i)
+        {
+            using Vec = typename O::Vec;
+
+            Vec vEta = O::Load(aArgs.mpEta + i);
+            Vec vAEtaSq = O::Mul(O::Set(aArgs.mA), O::Mul(vEta, vEta));
+            Vec vD = O::Mul(O::Set(aArgs.mSqrt2A), Exp<O>(O::Sub(O::Set(0.5f), vAEtaSq)));
+            O::Store(aArgs.mpD + i, vD);
+            O::Store(aArgs.mpLambda + i, O::Mul(vD, O::Sub(O::Set(1.f), O::Add(vAEtaSq, vAEtaSq))));
+        }
+
+        static void Friction(const FrictionArgs& aArgs)
+        {
+            int i = 0;
+            for (; i + Ops::kWidth <= aArgs.mCount; i += Ops::kWidth)
+            {
+                FrictionLanes<Ops>(aArgs, i);
+            }
+            for (; i < aArgs.mCount; ++i)
+            {
+                FrictionLanes<ScalarOps>(aArgs, i);
+            }
+        }
+
+        //Vectors per mode of a batch, each lane keeps its own accumulator
+        static constexpr int kBatchVecs = kBatchLanes / Ops::kWidth;
+        static_assert(kBatchLanes % Ops::kWidth == 0, "A batch must be a whole number of vectors");
+
+        static void BatchInputProjection(const float* apModesIn, const float* apVelocities, int aModesNumber, float* apProjections)
+        {
+            typename Ops::Vec vAcc[kBatchVecs];
+            for (int v = 0; v < kBatchVecs; ++v)
+            {
+                vAcc[v] = Ops::Set(0.f);
+            }
+            for (int m = 0; m < aModesNumber; ++m)
+            {
+                for (int v = 0; v < kBatchVecs; ++v)
+                {
+                    int i = m * kBatchLanes + v * Ops::kWidth;
+                    vAcc[v] = Ops::MulAdd(Ops::Load(apModesIn + i), Ops::Load(apVelocities + i), vAcc[v]);
+                }
+            }
+            for (int v = 0; v < kBatchVecs; ++v)
+            {
+                Ops::Store(apProjections + v * Ops::kWidth, vAcc[v]);
+            }
+        }
+
+        static void BatchFreeResponse(const FreeResponseArgs& aArgs, float* apProjections)
+        {
+            typename Ops::Vec vProjection[kBatchVecs];
+            for (int v = 0; v < kBatchVecs; ++v)
+            {
+                vProjection[v] = Ops::Set(0.f);
+            }
+            for (int m = 0; m < aArgs.mModesNumber; ++m)
+            {
+                for (int v = 0; v < kBatchVecs; ++v)
+                {
+                    FreeResponseLanes<Ops>(aArgs, m * kBatchLanes + v * Ops::kWidth, vProjection[v]);
+                }
+            }
+            for (int v = 0; v < kBatchVecs; ++v)
+            {
+                Ops::Store(apProjections + v * Ops::kWidth, vProjection[v]);
+            }
+        }
+
+        static void BatchWriteBack(const BatchWriteBackArgs& aArgs, float* apZeta1, float* apOutputs)
+        {
+            using Vec = typename Ops::Vec;
+
+            Vec vBowTerms[kBatchVecs];
+            Vec vZeta1[kBatchVecs];
+            Vec vOutput[kBatchVecs];
+            for (int v = 0; v < kBatchVecs; ++v)
+            {
+                vBowTerms[v] = Ops::Load(aArgs.mpBowTerms + v * Ops::kWidth);
+                vZeta1[v] = Ops::Set(0.f);
+                vOutput[v] = Ops::Set(0.f);
+            }
+            const Vec vHalfTimeStep = Ops::Set(aArgs.mHalfTimeStep);
+            for (int m = 0; m < aArgs.mModesNumber; ++m)
+            {
+                for (int v = 0; v < kBatchVecs; ++v)
+                {
+                    int i = m * kBatchLanes + v * Ops::kWidth;
+                    Vec vVel = Ops::Load(aArgs.mpVel + i);
+                    Vec vNextVel = Ops::MulAdd(Ops::Load(aArgs.mpModesInSchur + i), vBowTerms[v], Ops::Load(aArgs.mpFreeVel + i));
+                    Vec vNextDispl = Ops::MulAdd(vHalfTimeStep, Ops::Add(vVel, vNextVel), Ops::Load(aArgs.mpDispl + i));
+                    Ops::Store(aArgs.mpDispl + i, vNextDispl);
+                    Ops::Store(aArgs.mpVel + i, vNextVel);
+
+                    vZeta1[v] = Ops::MulAdd(Ops::Load(aArgs.mpModesIn + i), vNextVel, vZeta1[v]);
+                    vOutput[v] = Ops::MulAdd(Ops::Load(aArgs.mpModesOut + i), vNextDispl, vOutput[v]);
+                }
+            }
+            for (int v = 0; v < kBatchVecs; ++v)
+            {
+                Ops::Store(apZeta1 + v * Ops::kWidth, vZeta1[v]);
+                Ops::Store(apOutputs + v * Ops::kWidth, vOutput[v]);
+            }
+        }
+
+        static Kernel Make(Isa aIsa)
+        {
+            return Kernel{ aIsa, &InputProjection, &FreeResponse, &WriteBack, &FreeDecay, &Energy, &Friction,
+                &RampWriteBack, &RampFreeDecay, &RotateWriteBack, &BatchInputProjection, &BatchFreeResponse, &BatchWriteBack };
+        }
+    };
+}
+}
@@ -0,0 +1,60 @@
+/*
+  ==============================================================================
+
+    ModalKernelsSse2.cpp
+    Created: 17/10/2026
+
+  ==============================================================================
+*/
+
+#include "ModalKernelsImpl.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MODAL_KERNELS_SSE2 1
+#include <emmintrin.h>
+#else
+#define MODAL_KERNELS_SSE2 0
+#endif
+
+namespace ModalKernels
+{
+#if MODAL_KERNELS_SSE2
+namespace
+{
+    struct Sse2Ops
+    {
+        using Vec = __m128;
+        static constexpr int kWidth = 4;
+
+        static inline Vec Load(const float* apSrc) { return _mm_loadu_ps(apSrc); }
+        static inline void Store(float* apDst, Vec aV) { _mm_storeu_ps(apDst, aV); }
+        static inline Vec Set(float aV) { return _mm_set1_ps(aV); }
+        static inline Vec Add(Vec aA, Vec aB) { return _mm_add_ps(aA, aB); }
+        static inline Vec Sub(Vec aA, Vec aB) { return _mm_sub_ps(aA, aB); }
+        static inline Vec Mul(Vec aA, Vec aB) { return _mm_mul_ps(aA, aB); }
+        static inline Vec MulAdd(Vec aA, Vec aB, Vec aC) { return _mm_add_ps(_mm_mul_ps(aA, aB), aC); }
+        static inline Vec Max(Vec aA, Vec aB) { return _mm_max_ps(aA, aB); }
+        static inline Vec Round(Vec aV) { return _mm_cvtepi32_ps(_mm_cvtps_epi32(aV)); }
+        static inline Vec Pow2(Vec aN) { return _mm_castsi128_ps(_mm_slli_epi32(_mm_add_epi32(_mm_cvtps_epi32(aN), _mm_set1_epi32(127)), 23)); }
+        static inline float Sum(Vec aV)
+        {
+            Vec vHigh = _mm_movehl_ps(aV, aV);
+            Vec vSum = _mm_add_ps(aV, vHigh);
+            vSum = _mm_add_ss(vSum, _mm_shuffle_ps(vSum, vSum, 0x55));
+            return _mm_cvtss_f32(vSum);
+        }
+    };
+}
+
+    const Kernel* GetSse2Kernel()
+    {
+        static const Kernel kKernel = KernelImpl<Sse2Ops>::Make(Isa::Sse2);
+        return &kKernel;
+    }
+#else
+    const Kernel* GetSse2Kernel()
+    {
+        return nullptr;
+    }
+#endif
+}
@@ -1,34 +1,30 @@
 #include "ModalStiffStringProcessor.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include "ModeShapes.h"
 
 ModalStiffStringProcessor::ModalStiffStringProcessor (double aSampleRate, Global::Strings::String* apString)
+    : ModalStiffStringProcessor(ModalStringTables::Create(*apString, aSampleRate))
 {
-    auto vPi = juce::MathConstants<float>::pi;
-    mOversamplingFactor = 1;
-
-    mTimeStep = 1.0 / (aSampleRate * mOversamplingFactor);
-
-    mpString = apString;
-    mRadius = mpString->mRadius;
-    mDensity = mpString->mDensity;
-    mTension = mpString->mTension;
-    mLength = mpString->mLength;
-
-    mArea = vPi * mRadius * mRadius;
-    mLinDensity = mDensity * mArea;
-    mInertia = (vPi * mRadius * mRadius * mRadius * mRadius) / 4;
-    mK = sqrt(mYoungMod * mInertia / (mLinDensity * mLength * mLength * mLength * mLength));
-    mC = sqrt(mTension / mLinDensity);
+}
 
+ModalStiffStringProcessor::ModalStiffStringProcessor(std::shared_ptr<const ModalStringTables> apTables)
+{
     mA = 100.f;
+    mFriction = BowFriction::Evaluator(mA);
 
-    RecomputeModesNumber();
-    RecomputeEigenFreqs();
-    InitializeInModes();
-    InitializeOutModes();
-    RecomputeDampProfile();
+    mpKernel = ModalKernels::GetKernel(ModalKernels::GetBestSupportedIsa());
 
-    InitializeStates();
-    ResetMatrices();
+    mEngines.push_back(std::make_unique<Engine>());
+    mpEditedEngine = mEngines.back().get();
+    mpEditedEngine->mpTables = std::move(apTables);
+    mLength = mpEditedEngine->mpTables->GetLength();
+    AllocateEngine(*mpEditedEngine);
+    InitializeModes(*mpEditedEngine);
+
+    mpEngine = mpEditedEngine;
+    BindEngine();
 }
 
 ModalStiffStringProcessor::~ModalStiffStringProcessor()
@@ -38,16 +34,9 @@ ModalStiffStringProcessor::~ModalStiffStringProcessor()
 //==========================================================================
 void ModalStiffStringProcessor::SetTimeStep(double aTimeStep)
 {
-    bool vCurrPlayState = mPlayState;
-    if (vCurrPlayState)
-    {
-        mPlayState.store(false);
-    }
-    mTimeStep = aTimeStep;
-    if (vCurrPlayState)
-    {
-        mPlayState.store(true);
-    }
+    const ModalStringTables& vTables = *mpEditedEngine->mpTables;
+    PublishEngine(std::make_shared<const ModalStringTables>(vTables.GetString(), aTimeStep, vTables.GetOversamplingFactor()),
+        true, mpEditedEngine->mPickupsNumber);
 }
 
 void ModalStiffStringProcessor::SetPlayState(bool aPlayState)
@@ -57,12 +46,9 @@ void ModalStiffStringProcessor::SetPlayState(bool aPlayState)
 
 void ModalStiffStringProcessor::ResetStringStates()
 {
-    if (mPlayState.load())
-    {
-        mPlayState.store(false);
-    }
-    std::fill(mStates[0].begin(), mStates[0].end(), 0);
-    std::fill(mStates[1].begin(), mStates[1].end(), 0);
+    //The states belong to the audio thread, which zeroes them at its next block
+    mPlayState.store(false);
+    mIsResetPending.store(true, std::memory_order_release);
 }
 
 void ModalStiffStringProcessor::SetInputPos(float aNewPos)
@@ -74,25 +60,65 @@ void ModalStiffStringProcessor::SetInputPos(float aNewPos)
     }
     else
     {
-        jassertfalse;
+        assert(false);
     }
     RecomputeInModes();
 }
 
 void ModalStiffStringProcessor::SetReadPos(float aNewPos)
+{
+    SetPickupPos(0, aNewPos);
+}
+
+void ModalStiffStringProcessor::SetPickupsNumber(int aPickupsNumber)
+{
+    assert(aPickupsNumber >= 1 && aPickupsNumber <= kMaxPickups);
+    aPickupsNumber = std::min(std::max(aPickupsNumber, 1), kMaxPickups);
+    for (int k = mpEditedEngine->mPickupsNumber; k < aPickupsNumber; ++k)
+    {
+        mReadPos[k] = mReadPos[0];
+    }
+    PublishEngine(mpEditedEngine->mpTables, true, aPickupsNumber);
+}
+
+int ModalStiffStringProcessor::GetPickupsNumber()
+{
+    return mpEditedEngine->mPickupsNumber;
+}
+
+void ModalStiffStringProcessor::SetPickupPos(int aPickup, float aNewPos)
 {
     //Position is in normalized percentage of string length
-    if (aNewPos >= 0 && aNewPos <= 1)
+    if (aPickup >= 0 && aPickup < kMaxPickups && aNewPos >= 0 && aNewPos <= 1)
     {
-        mReadPos = aNewPos * mLength;
+        mReadPos[aPickup] = aNewPos * mLength;
     }
     else
     {
-        jassertfalse;
+        assert(false);
     }
     RecomputeOutModes();
 }
 
+void ModalStiffStringProcessor::SetPickupsReadPos(float aNewPos)
+{
+    assert(aNewPos >= 0 && aNewPos <= 1);
+    aNewPos = std::min(std::max(aNewPos, 0.f), 1.f);
+    const int vPickupsNumber = mpEditedEngine->mPickupsNumber;
+    for (int k = 0; k < vPickupsNumber; ++k)
+    {
+        float vPos = aNewPos + static_cast<float>(k / 2) / vPickupsNumber;
+        vPos = vPos > 1.f ? vPos - 1.f : vPos;
+        mReadPos[k] = (k % 2 == 0 ? vPos : 1.f - vPos) * mLength;
+    }
+    RecomputeOutModes();
+}
+
+float ModalStiffStringProcessor::GetReadPos()
+{
+    return mReadPos[0] / mLength;
+}
+
 void ModalStiffStringProcessor::SetGain(float aGain)
 {
     mGain.store(aGain);
@@ -110,291 +136,888 @@ void ModalStiffStringProcessor::SetBowSpeed(float aSpeed)
 
 void ModalStiffStringProcessor::SetString(Global::Strings::String* apString)
 {
-    auto vPi = juce::MathConstants<float>::pi;
+    const ModalStringTables& vTables = *mpEditedEngine->mpTables;
+    PublishEngine(std::make_shared<const ModalStringTables>(*apString, vTables.GetTimeStep(), vTables.GetOversamplingFactor()),
+        false, mpEditedEngine->mPickupsNumber);
+}
 
-    mpString = apString;
-    mRadius = mpString->mRadius;
-    mDensity = mpString->mDensity;
-    mTension = mpString->mTension;
-    mLength = mpString->mLength;
+void ModalStiffStringProcessor::SetTables(std::shared_ptr<const ModalStringTables> apTables)
+{
+    SwitchTables(std::move(apTables));
+    InitializeModes(*mpEditedEngine);
+    BindEngine();
+}
 
-    mArea = vPi * mRadius * mRadius;
-    mLinDensity = mDensity * mArea;
-    mInertia = (vPi * mRadius * mRadius * mRadius * mRadius) / 4;
-    mK = sqrt(mYoungMod * mInertia / (mLinDensity * mLength * mLength * mLength * mLength));
-    mC = sqrt(mTension / mLinDensity);
+void ModalStiffStringProcessor::ComputeStringModes(StringModes& aModes, float aInputPos, float aReadPos) const
+{
+    const ModalStringTables& vTables = *aModes.mpTables;
+    aModes.mModesIn.assign(2 * static_cast<std::size_t>(vTables.GetModesStride()), 0.f);
+    aModes.mModesOut.assign(vTables.GetModesStride(), 0.f);
+    ComputeModesIn(vTables, aInputPos * vTables.GetLength(), aModes.mModesIn.data());
+    ComputeModesOut(vTables, aReadPos * vTables.GetLength(), aModes.mModesOut.data());
+    aModes.mInputPos = aInputPos;
+    aModes.mReadPos = aReadPos;
+}
 
-    ResetStringStates();
-    RecomputeModesNumber();
-    RecomputeEigenFreqs();
-    InitializeInModes();
-    InitializeOutModes();
-    RecomputeDampProfile();
-    InitializeStates();
-    ResetMatrices();
+void ModalStiffStringProcessor::SetTables(const StringModes& aModes)
+{
+    SwitchTables(aModes.mpTables);
+    SetModes(aModes);
+    //The engine is not rendered yet, the first mode shapes are read at once
+    mpEditedEngine->mModesIn.Acquire();
+    mpEditedEngine->mModesOut.Acquire();
+    BindEngine();
+}
+
+void ModalStiffStringProcessor::SetModes(const StringModes& aModes)
+{
+    assert(mpEditedEngine->mPickupsNumber == 1 && aModes.mpTables == mpEditedEngine->mpTables);
+    mExcitPos = aModes.mInputPos * mLength;
+    mReadPos[0] = aModes.mReadPos * mLength;
+
+    //The audio thread crossfades to the copied mode shapes at its next block
+    Engine& vEngine = *mpEditedEngine;
+    std::copy(aModes.mModesIn.begin(), aModes.mModesIn.end(), vEngine.mpModesInBuffers[vEngine.mModesIn.GetWriteIndex()]);
+    std::copy(aModes.mModesOut.begin(), aModes.mModesOut.end(), vEngine.mpModesOutBuffers[vEngine.mModesOut.GetWriteIndex()]);
+    vEngine.mModesIn.Publish();
+    vEngine.mModesOut.Publish();
+}
+
+std::shared_ptr<const ModalStringTables> ModalStiffStringProcessor::GetTables()
+{
+    return mpEditedEngine->mpTables;
 }
 
 void ModalStiffStringProcessor::ComputeState()
 {
+    AdoptPendingEngine();
+    if (mPlayState.load())
+    {
+        float vOutputValue = 0.f;
+        float* vpOutput = &vOutputValue;
+        RenderBlock(*ModalKernels::GetScalarKernel(), &vpOutput, 1, 1);
+    }
+}
+
+float ModalStiffStringProcessor::ReadOutput()
+{
+    float vOutputValue = 0.f;
     if (mPlayState.load())
     {
-        for (int vOS = 0; vOS < mOversamplingFactor; ++vOS)
+        //Inactive modes have zero displacement, the first pickup is read
+        const float* const vpModesOut = mpEngine->mpModesOutBuffers[mpEngine->mModesOut.GetReadIndex()];
+        for (int s = 0; s < mActiveModesNumber; ++s)
         {
-            //Computing input projection
-            float vZeta1 = 0.f;
-            for (int i = 0; i < mModesNumber; ++i)
-            {
-                vZeta1 += mpModesInCurr.load()[i] * mpStatesPtrs[0][i + mModesNumber];
-            }
+            int i = mpActiveModes[s];
+            vOutputValue += vpModesOut[i] * mpDispl[i];
+        }
+    }
+    return (mGain.load() * vOutputValue);
+}
 
-            //Computing bow input
-            float vEta = vZeta1 - mVb.load();
-            float vD = sqrt(2 * mA) * exp(-mA * vEta * vEta + 0.5);
-            float vLambda = vD * (1 - 2 * mA * vEta * vEta);
+bool ModalStiffStringProcessor::ProcessBlock(float* apOutput, int aNumSamples)
+{
+    return ProcessModulatedBlock(&apOutput, 1, aNumSamples, nullptr);
+}
 
-            float vVt1 = 0.f;
-            float vVt2 = 0.f;
+bool ModalStiffStringProcessor::ProcessBlock(float* apOutput, int aNumSamples, const float* apInputPos)
+{
+    InputPosModulation vModulation{ apInputPos, 0.f, 0.f };
+    return ProcessModulatedBlock(&apOutput, 1, aNumSamples, &vModulation);
+}
 
-            //Computing known terms
-            for (int i = 0; i < mModesNumber; ++i)
-            {
-                float vZeta2 = mpModesInCurr.load()[i] * vZeta1;
-
-                //Notice that the first half of zeta in the matlab code is made of zeroes, 
-                //so there is no point of computing multiplications by it
-                float vB1 = mB11[i] * mpStatesPtrs[0][i] + mB12[i] * mpStatesPtrs[0][i + mModesNumber];
-                float vB2 = mB21[i] * mpStatesPtrs[0][i] + mB22[i] * mpStatesPtrs[0][i + mModesNumber] +
-                    vZeta2 * 0.5f * mTimeStep * mFb.load() * (vLambda - 2 * vD) +
-                    mTimeStep * mFb.load() * vD * mpModesInCurr.load()[i] * mVb.load();
-
-                //Computing T^-1*a (see overleaf notes)
-                float vZ1 = 0.5f * mTimeStep * mFb.load() * vLambda * mpModesInCurr.load()[i];
-                mInvAv2[i] = (1 / mSchurComp[i]) * vZ1;
-                mInvAv1[i] = -mT11[i] * mT12[i] * mInvAv2[i];
-
-                //Computing T^-1*[j1;j1] (see overleaf notes)
-                float vY2 = mT11[i] * vB1;
-                float vZ2 = vB2 - mT21[i] * vY2;
-                mInvAb2[i] = (1 / mSchurComp[i]) * vZ2;
-                mInvAb1[i] = vY2 - mT11[i] * mT12[i] * mInvAb2[i];
-
-                vVt1 += mpModesInCurr.load()[i] * mInvAv2[i];
-                vVt2 += mpModesInCurr.load()[i] * mInvAb2[i];
-            }
+bool ModalStiffStringProcessor::ProcessBlock(float* apOutput, int aNumSamples, float aStartPos, float aEndPos)
+{
+    InputPosModulation vModulation{ nullptr, aStartPos, aEndPos };
+    return ProcessModulatedBlock(&apOutput, 1, aNumSamples, &vModulation);
+}
+
+bool ModalStiffStringProcessor::ProcessBlock(float* const* apOutputs, int aOutputsNumber, int aNumSamples)
+{
+    return ProcessModulatedBlock(apOutputs, aOutputsNumber, aNumSamples, nullptr);
+}
+
+float ModalStiffStringProcessor::InputPosModulation::GetPos(int aSample, int aNumSamples) const
+{
+    float vPos = mpPositions ? mpPositions[aSample]
+        : aNumSamples > 1 ? mStartPos + (mEndPos - mStartPos) * aSample / (aNumSamples - 1) : mEndPos;
+    return std::min(std::max(vPos, 0.f), 1.f);
+}
+
+bool ModalStiffStringProcessor::ProcessModulatedBlock(float* const* apOutputs, int aOutputsNumber, int aNumSamples,
+    const InputPosModulation* apModulation)
+{
+    AdoptPendingEngine();
+
+    //Hosts may send empty blocks, the last position of a modulation does not exist
+    if (aNumSamples <= 0)
+    {
+        return false;
+    }
 
-            float vCoeff = 1 / (1 + vVt1);
+    //The engine may have fewer pickups than asked for until it adopts the new ones
+    const int vPickupsNumber = std::min(aOutputsNumber, mPickupsNumber);
+    for (int k = vPickupsNumber; k < aOutputsNumber; ++k)
+    {
+        std::fill(apOutputs[k], apOutputs[k] + aNumSamples, 0.f);
+    }
+    if (!mPlayState.load())
+    {
+        for (int k = 0; k < vPickupsNumber; ++k)
+        {
+            std::fill(apOutputs[k], apOutputs[k] + aNumSamples, 0.f);
+        }
+        return false;
+    }
 
-            for (int i = 0; i < mModesNumber; ++i)
+    //A sleeping string has zero states, so it stays silent until bowed again
+    bool vIsBowed = mFb.load() != 0.f;
+    if (mIsSleeping.load())
+    {
+        if (!vIsBowed)
+        {
+            for (int k = 0; k < vPickupsNumber; ++k)
             {
-                mpStatesPtrs[1][i] = mInvAb1[i] - vCoeff * mInvAv1[i] * vVt2;
-                mpStatesPtrs[1][i + mModesNumber] = mInvAb2[i] - vCoeff * mInvAv2[i] * vVt2;
+                std::fill(apOutputs[k], apOutputs[k] + aNumSamples, 0.f);
             }
+            return false;
+        }
+        mIsSleeping.store(false);
+    }
+
+    RenderBlock(*mpKernel, apOutputs, vPickupsNumber, aNumSamples, apModulation);
 
-            //Pointers switch
-            auto vpStatePointer = mpStatesPtrs[0];
-            mpStatesPtrs[0] = mpStatesPtrs[1];
-            mpStatesPtrs[1] = vpStatePointer;
+    if (!vIsBowed)
+    {
+        float vEnergy = mpKernel->mpEnergy(mpEigenFreqs, mpDispl, mpVel, mModesNumber);
+        if (vEnergy < mSleepEnergyFloor.load())
+        {
+            InitializeStates();
+            mIsSleeping.store(true);
         }
     }
+    return true;
 }
 
-float ModalStiffStringProcessor::ReadOutput()
+void ModalStiffStringProcessor::SetSleepEnergyFloor(float aEnergyFloor)
 {
-    float vOutputValue = 0.f;
-    if (mPlayState.load())
+    mSleepEnergyFloor.store(aEnergyFloor);
+}
+
+bool ModalStiffStringProcessor::IsSleeping()
+{
+    return mIsSleeping.load();
+}
+
+float ModalStiffStringProcessor::GetEnergy()
+{
+    return mpKernel->mpEnergy(mpEigenFreqs, mpDispl, mpVel, mModesNumber);
+}
+
+void ModalStiffStringProcessor::SetModeEnergyThreshold(float aThreshold)
+{
+    mModeEnergyThreshold.store(aThreshold);
+}
+
+int ModalStiffStringProcessor::GetActiveModesNumber()
+{
+    return mActiveModesNumber;
+}
+
+void ModalStiffStringProcessor::SetNodeWeightThreshold(float aThreshold)
+{
+    mNodeWeightThreshold = aThreshold;
+    RecomputeInModes();
+    RecomputeOutModes();
+}
+
+void ModalStiffStringProcessor::SetModesCrossfade(bool aIsEnabled)
+{
+    mIsModesCrossfade.store(aIsEnabled);
+}
+
+void ModalStiffStringProcessor::RenderBlock(const ModalKernels::Kernel& aKernel, float* const* apOutputs, int aOutputsNumber,
+    int aNumSamples, const InputPosModulation* apModulation)
+{
+    //Snapshot of the values shared with the other threads, kept for the whole block
+    const float vFb = mFb.load();
+
+    //The active set is predicted from the bow terms of the previous block, so at
+    //the onset of a note, with no previous bow, every mode can take part
+    if (vFb != 0.f && !mWasBowed && mActiveModesNumber < mModesNumber)
+    {
+        ResetActiveModes();
+    }
+    mWasBowed = vFb != 0.f;
+
+    Engine& vEngine = *mpEngine;
+    const int vTablesVersion = mTablesVersion.load();
+    const float* vpModesIn = vEngine.mpModesInBuffers[vEngine.mModesIn.GetReadIndex()];
+    const float* vpModesOut = vEngine.mpModesOutBuffers[vEngine.mModesOut.GetReadIndex()];
+    const float vVb = mVb.load();
+    const float vGain = mGain.load();
+
+    if (vTablesVersion != mGatheredVersion)
+    {
+        GatherWorkingSet(mIsInputModulated ? mpModulatedModesIn : vpModesIn, vpModesOut);
+        mGatheredVersion = vTablesVersion;
+    }
+
+    //Mode shapes published since the previous block are reached at the end of
+    //this one, or at once if the string is at rest or the crossfade is off.
+    //A moving bow sets the input mode shapes itself, and after it they go back
+    //to the published ones the same way
+    bool vIsInputAcquired = vEngine.mModesIn.Acquire();
+    bool vIsRamp = vEngine.mModesOut.Acquire();
+    vIsRamp = vIsRamp || (!apModulation && (vIsInputAcquired || mIsInputModulated));
+    vpModesIn = vEngine.mpModesInBuffers[vEngine.mModesIn.GetReadIndex()];
+    vpModesOut = vEngine.mpModesOutBuffers[vEngine.mModesOut.GetReadIndex()];
+    if (vIsRamp && (mIsAtRest || !mIsModesCrossfade.load()))
+    {
+        GatherWorkingSet(vpModesIn, vpModesOut);
+        vIsRamp = false;
+    }
+    ModalKernels::ModesRampArgs vRampArgs;
+    vRampArgs.mpModesIn = mpSlotModesIn;
+    vRampArgs.mpModesInSchur = mpSlotModesIn + mModesStride;
+    vRampArgs.mpModesOut = mpSlotModesOut;
+    vRampArgs.mpModesInStep = mpSlotModesInStep;
+    vRampArgs.mpModesInSchurStep = mpSlotModesInStep + mModesStride;
+    vRampArgs.mpModesOutStep = mpSlotModesOutStep;
+
+    const int vModesNumber = mActiveModesNumber;
+    for (int s = 0; s < vModesNumber; ++s)
+    {
+        mpSlotDispl[s] = mpDispl[mpActiveModes[s]];
+        mpSlotVel[s] = mpVel[mpActiveModes[s]];
+    }
+
+    float vBowTermsSum = 0.f;
+    if (vFb == 0.f)
+    {
+        //Without bow the input mode shapes are not read
+        ModalKernels::FreeDecayArgs vFreeDecayArgs;
+        vFreeDecayArgs.mpModesOut = mpSlotModesOut;
+        vFreeDecayArgs.mpM11 = mpSlotDecayM11;
+        vFreeDecayArgs.mpM12 = mpSlotDecayM12;
+        vFreeDecayArgs.mpM21 = mpSlotDecayM21;
+        vFreeDecayArgs.mpM22 = mpSlotDecayM22;
+        vFreeDecayArgs.mpDispl = mpSlotDispl;
+        vFreeDecayArgs.mpVel = mpSlotVel;
+        vFreeDecayArgs.mModesNumber = vModesNumber;
+        vFreeDecayArgs.mPickupsNumber = aOutputsNumber;
+        vFreeDecayArgs.mModesOutStride = mModesStride;
+        if (vIsRamp)
+        {
+            PrepareModesRamp(vpModesIn, vpModesOut, aNumSamples);
+            aKernel.mpRampFreeDecay(vFreeDecayArgs, vRampArgs, apOutputs, aNumSamples);
+        }
+        else
+        {
+            aKernel.mpFreeDecay(vFreeDecayArgs, apOutputs, aNumSamples);
+        }
+
+        for (int k = 0; k < aOutputsNumber; ++k)
+        {
+            for (int n = 0; n < aNumSamples; ++n)
+            {
+                apOutputs[k][n] *= vGain;
+            }
+        }
+    }
+    else
     {
-        for (int i = 0; i < mModesNumber; ++i)
+        const float* const vpSlotModesInSchur = mpSlotModesIn + mModesStride;
+        const float vHalfKFb = static_cast<float>(0.5 * mTimeStep * vFb);
+        const float vKFbVb = static_cast<float>(mTimeStep * vFb * vVb);
+
+        //w^T * T^-1 * w over the active modes, the same for every sample of the block
+        //unless crossfading, when it is the quadratic a + b * j + c * j^2 of the step j,
+        //or moving the bow, when the write-back returns it for each step
+        float vInSchurProjection = aKernel.mpInputProjection(mpSlotModesIn, vpSlotModesInSchur, vModesNumber);
+        float vInSchurProjectionB = 0.f;
+        float vInSchurProjectionC = 0.f;
+        if (vIsRamp)
+        {
+            PrepareModesRamp(vpModesIn, vpModesOut, aNumSamples * mOversamplingFactor);
+            vInSchurProjectionB = aKernel.mpInputProjection(mpSlotModesIn, vRampArgs.mpModesInSchurStep, vModesNumber)
+                + aKernel.mpInputProjection(mpSlotModesInStep, vpSlotModesInSchur, vModesNumber);
+            vInSchurProjectionC = aKernel.mpInputProjection(mpSlotModesInStep, vRampArgs.mpModesInSchurStep, vModesNumber);
+        }
+        else if (apModulation)
+        {
+            for (int k = 0; k < aOutputsNumber; ++k)
+            {
+                std::fill(mpSlotModesOutStep + k * mModesStride, mpSlotModesOutStep + k * mModesStride + vModesNumber, 0.f);
+            }
+        }
+        const bool vIsInputRamp = vIsRamp && !apModulation;
+        const float vInSchurProjectionA = vInSchurProjection;
+        int vStep = 0;
+
+        ModalKernels::FreeResponseArgs vFreeResponseArgs;
+        vFreeResponseArgs.mpModesIn = mpSlotModesIn;
+        vFreeResponseArgs.mpDispl = mpSlotDispl;
+        vFreeResponseArgs.mpVel = mpSlotVel;
+        vFreeResponseArgs.mpVelDisplCoeffs = mpSlotVelDisplCoeffs;
+        vFreeResponseArgs.mpVelVelCoeffs = mpSlotVelVelCoeffs;
+        vFreeResponseArgs.mpFreeVel = mpFreeVel;
+        vFreeResponseArgs.mModesNumber = vModesNumber;
+
+        ModalKernels::WriteBackArgs vWriteBackArgs;
+        vWriteBackArgs.mpModesIn = mpSlotModesIn;
+        vWriteBackArgs.mpModesInSchur = vpSlotModesInSchur;
+        vWriteBackArgs.mpModesOut = mpSlotModesOut;
+        vWriteBackArgs.mpFreeVel = mpFreeVel;
+        vWriteBackArgs.mHalfTimeStep = static_cast<float>(0.5 * mTimeStep);
+        vWriteBackArgs.mpDispl = mpSlotDispl;
+        vWriteBackArgs.mpVel = mpSlotVel;
+        vWriteBackArgs.mModesNumber = vModesNumber;
+        vWriteBackArgs.mPickupsNumber = aOutputsNumber;
+        vWriteBackArgs.mModesOutStride = mModesStride;
+
+        ModalKernels::ModesRotationArgs vRotationArgs;
+        vRotationArgs.mpModesIn = mpSlotModesIn;
+        vRotationArgs.mpModesInQuad = mpSlotModesInQuad;
+        vRotationArgs.mpModesInSchur = mpSlotModesIn + mModesStride;
+        vRotationArgs.mpModesOut = mpSlotModesOut;
+        vRotationArgs.mpRotationCos = mpSlotRotationCos;
+        vRotationArgs.mpRotationSin = mpSlotRotationSin;
+        vRotationArgs.mpInvSchurComp = mpSlotInvSchurComp;
+        vRotationArgs.mpModesOutStep = mpSlotModesOutStep;
+        int vNextRestart = 0;
+
+        //Input projection of the first sample, the following ones are accumulated
+        //while writing the new states
+        float vZeta1 = aKernel.mpInputProjection(mpSlotModesIn, mpSlotVel, vModesNumber);
+
+        for (int n = 0; n < aNumSamples; ++n)
         {
-            vOutputValue += mpModesOutCurr.load()[i] * mpStatesPtrs[0][i];
+            //A moving bow starts from exact mode shapes every kModulationStep
+            //samples and turns them towards the position of the next restart
+            if (apModulation && n == vNextRestart)
+            {
+                vNextRestart = std::min(n + kModulationStep, aNumSamples);
+                const int vTarget = std::min(vNextRestart, aNumSamples - 1);
+                const float vPos = apModulation->GetPos(n, aNumSamples);
+                const float vStepAngle = vTarget > n
+                    ? static_cast<float>(Global::kPi * (apModulation->GetPos(vTarget, aNumSamples) - vPos) / ((vTarget - n) * mOversamplingFactor))
+                    : 0.f;
+                PrepareModesRotation(vPos, vStepAngle);
+                vInSchurProjection = aKernel.mpInputProjection(mpSlotModesIn, vpSlotModesInSchur, vModesNumber);
+                vZeta1 = aKernel.mpInputProjection(mpSlotModesIn, mpSlotVel, vModesNumber);
+            }
+
+            float vOutputValues[kMaxPickups];
+            for (int vOS = 0; vOS < mOversamplingFactor; ++vOS)
+            {
+                //Computing bow input
+                float vEta = vZeta1 - vVb;
+                float vD, vLambda;
+                mFriction.Evaluate(aKernel, vEta, vD, vLambda);
+
+                //Known terms: B*x = free response + w * vZeta1Coeff, A = T + vZ1Coeff * w * w^T
+                float vZeta1Coeff = vHalfKFb * (vLambda - 2 * vD) * vZeta1 + vKFbVb * vD;
+                float vZ1Coeff = vHalfKFb * vLambda;
+                float vFreeProjection = aKernel.mpFreeResponse(vFreeResponseArgs);
+
+                if (vIsInputRamp)
+                {
+                    float vJ = static_cast<float>(vStep++);
+                    vInSchurProjection = vInSchurProjectionA + vJ * (vInSchurProjectionB + vJ * vInSchurProjectionC);
+                }
+
+                //Sherman-Morrison: vt1 = vZ1Coeff * w^T*T^-1*w, vt2 = w^T*T^-1*(B*x)
+                float vVt1 = vZ1Coeff * vInSchurProjection;
+                float vVt2 = vFreeProjection + vZeta1Coeff * vInSchurProjection;
+                vWriteBackArgs.mBowTerm = vZeta1Coeff - vZ1Coeff * vVt2 / (1 + vVt1);
+                vBowTermsSum += std::abs(vWriteBackArgs.mBowTerm);
+
+                //Writing the new states, together with the input projection for the
+                //next step and the output projection
+                if (apModulation)
+                {
+                    aKernel.mpRotateWriteBack(vWriteBackArgs, vRotationArgs, vZeta1, vInSchurProjection, vOutputValues);
+                }
+                else if (vIsRamp)
+                {
+                    aKernel.mpRampWriteBack(vWriteBackArgs, vRampArgs, vZeta1, vOutputValues);
+                }
+                else
+                {
+                    aKernel.mpWriteBack(vWriteBackArgs, vZeta1, vOutputValues);
+                }
+            }
+            for (int k = 0; k < aOutputsNumber; ++k)
+            {
+                apOutputs[k][n] = vGain * vOutputValues[k];
+            }
         }
     }
-    return (mGain.load() * vOutputValue);
+
+    for (int s = 0; s < vModesNumber; ++s)
+    {
+        mpDispl[mpActiveModes[s]] = mpSlotDispl[s];
+        mpVel[mpActiveModes[s]] = mpSlotVel[s];
+    }
+    //A moving bow ends at the exact mode shapes of its last position
+    if (apModulation)
+    {
+        ComputeModulatedModes(apModulation->GetPos(aNumSamples - 1, aNumSamples));
+        vpModesIn = mpModulatedModesIn;
+    }
+    mIsInputModulated = apModulation != nullptr;
+
+    //The steps add up to the new mode shapes only up to rounding
+    if (vIsRamp || apModulation)
+    {
+        GatherWorkingSet(vpModesIn, vpModesOut);
+    }
+    mIsAtRest = false;
+    UpdateActiveModes(vpModesIn, vpModesOut, vBowTermsSum);
+}
+
+bool ModalStiffStringProcessor::SetKernelIsa(ModalKernels::Isa aIsa)
+{
+    if (!ModalKernels::IsSupported(aIsa))
+    {
+        return false;
+    }
+    mpKernel = ModalKernels::GetKernel(aIsa);
+    return true;
+}
+
+ModalKernels::Isa ModalStiffStringProcessor::GetKernelIsa()
+{
+    return mpKernel->mIsa;
+}
+
+void ModalStiffStringProcessor::SetFrictionAccuracy(BowFriction::Accuracy aAccuracy)
+{
+    mFriction.SetAccuracy(aAccuracy);
+}
+
+BowFriction::Accuracy ModalStiffStringProcessor::GetFrictionAccuracy()
+{
+    return mFriction.GetAccuracy();
 }
 
 int ModalStiffStringProcessor::GetModesNumber()
 {
-    return mModesNumber;
+    return mpEditedEngine->mpTables->GetModesNumber();
 }
 
 void ModalStiffStringProcessor::GetModesAtLocation(std::vector<float>& aModesArray, float aLocationPerc)
 {
-    aModesArray.resize(mModesNumber, 0.f);
-    auto vPos = aLocationPerc * mLength;
-    for (int i = 0; i < mModesNumber; ++i)
-    {
-        auto vMode = ComputeMode(vPos, i + 1);
-        aModesArray[i] = vMode;
-    }
+    aModesArray.resize(GetModesNumber(), 0.f);
+    mpEditedEngine->mpTables->ComputeModes(aLocationPerc * mLength, aModesArray.data());
 }
 
 std::vector<float> ModalStiffStringProcessor::GetStringState()
 {
-    std::vector<float> vState(mModesNumber);
-    std::copy(mStates[0].begin(), mStates[0].begin() + mModesNumber, vState.begin());
+    const float* vpDispl = mpEditedEngine->mpDispl;
+    std::vector<float> vState(vpDispl, vpDispl + GetModesNumber());
     return vState;
 }
 
 //==========================================================================
-float ModalStiffStringProcessor::ComputeEigenFreq(int aModeNumber)
+void ModalStiffStringProcessor::CullNodeWeights(float* apModes, const ModalStringTables& aTables) const
 {
-    auto vN = aModeNumber * juce::MathConstants<float>::pi / mLength;
-    return sqrt((mTension / mLinDensity) * vN * vN + (mYoungMod * mInertia / mLinDensity) * vN * vN * vN * vN);
+    //Mode shapes peak at sqrt(2 / L)
+    const float vMinWeight = mNodeWeightThreshold * sqrt(2 / aTables.GetLength());
+    for (int i = 0; i < aTables.GetModesNumber(); ++i)
+    {
+        apModes[i] = std::abs(apModes[i]) < vMinWeight ? 0.f : apModes[i];
+    }
 }
 
-float ModalStiffStringProcessor::ComputeMode(float aPos, int aModeNumber)
+void ModalStiffStringProcessor::ComputeModesIn(const ModalStringTables& aTables, float aPos, float* apModesIn) const
 {
-    return sqrt(2 / mLength) * sin(aModeNumber * juce::MathConstants<float>::pi * aPos / mLength);
+    auto vpModesInSchur = apModesIn + aTables.GetModesStride();
+    aTables.ComputeModes(aPos, apModesIn);
+    CullNodeWeights(apModesIn, aTables);
+    for (int i = 0; i < aTables.GetModesNumber(); ++i)
+    {
+        vpModesInSchur[i] = apModesIn[i] * aTables.GetInvSchurComp()[i];
+    }
 }
 
-float ModalStiffStringProcessor::ComputeDampCoeff(float aFreq)
+void ModalStiffStringProcessor::ComputeModesOut(const ModalStringTables& aTables, float aPos, float* apModesOut) const
 {
-    auto vPi = juce::MathConstants<float>::pi;
-    float vRhoAir = 1.225f;
-    float vMuAir = (float)1.619e-5;
-    auto vD0 = -2 * vRhoAir * vMuAir / (mDensity * mRadius * mRadius);
-    auto vD1 = -2 * vRhoAir * sqrt(2 * vMuAir) / (mDensity * mRadius);
-    auto vD2 = static_cast<float>(-1 / 18000);
-    auto vD3 = -0.003f * mYoungMod * mDensity * vPi * vPi * mRadius * mRadius * mRadius * mRadius * mRadius * mRadius / (4 * mTension * mTension);
-    return vD0 + vD1 * sqrt(aFreq) + vD2 * aFreq + vD3 * aFreq * aFreq * aFreq;
+    aTables.ComputeModes(aPos, apModesOut);
+    CullNodeWeights(apModesOut, aTables);
 }
 
-void ModalStiffStringProcessor::RecomputeModesNumber()
+void ModalStiffStringProcessor::SwitchTables(std::shared_ptr<const ModalStringTables> apTables)
 {
-    int vModesNumber = 1;
-    float vLimitFreq = 20e3 * 2 * juce::MathConstants<float>::pi;
-    while (true)
+    mPlayState.store(false);
+    float vOldLength = mLength;
+    mpEditedEngine->mpTables = std::move(apTables);
+    mLength = mpEditedEngine->mpTables->GetLength();
+    mExcitPos *= mLength / vOldLength;
+    for (float& vReadPos : mReadPos)
     {
-        auto vFreq = ComputeEigenFreq(vModesNumber);
-        if (vFreq > vLimitFreq) 
-        {
-            --vModesNumber;
-            break;
-        }
-        ++vModesNumber;
+        vReadPos *= mLength / vOldLength;
     }
-    mModesNumber = vModesNumber;    
+    AllocateEngine(*mpEditedEngine);
+    //Another string, the states are zeroed when binding
+    mpEditedEngine->mKeepsStates = false;
 }
 
-void ModalStiffStringProcessor::RecomputeEigenFreqs()
+void ModalStiffStringProcessor::AllocateEngine(Engine& aEngine)
 {
-    mEigenFreqs.resize(mModesNumber);
-    for (int i = 0; i < mModesNumber; ++i)
+    //3 input mode buffers of 2 arrays each, 3 output mode buffers of 1 array
+    //per pickup, 2 state arrays, 10 + 1 per pickup working set arrays, 2 + 1
+    //per pickup step arrays, 4 + 5 moving bow arrays and 1 scratch array
+    const int vPickupsNumber = aEngine.mPickupsNumber;
+    const int vArraysNumber = 3 * 2 + 3 * vPickupsNumber + 2 + 10 + vPickupsNumber + 2 + vPickupsNumber + 4 + 5 + 1;
+    const int vModesStride = aEngine.mpTables->GetModesStride();
+    aEngine.mArena.Allocate(vArraysNumber * static_cast<std::size_t>(vModesStride));
+
+    float* vpArray = aEngine.mArena.GetData();
+    auto vNextArray = [&vpArray, vModesStride](int aArraysNumber)
+    {
+        float* vpStart = vpArray;
+        vpArray += aArraysNumber * vModesStride;
+        return vpStart;
+    };
+
+    for (float*& vpBuffer : aEngine.mpModesInBuffers)
+    {
+        vpBuffer = vNextArray(2);
+    }
+    for (float*& vpBuffer : aEngine.mpModesOutBuffers)
     {
-        mEigenFreqs[i] = ComputeEigenFreq(i + 1);
+        vpBuffer = vNextArray(vPickupsNumber);
     }
+
+    aEngine.mpDispl = vNextArray(1);
+    aEngine.mpVel = vNextArray(1);
+    aEngine.mpSlotArrays = vpArray;
+
+    aEngine.mActiveModes.resize(aEngine.mpTables->GetModesNumber());
+    aEngine.mIsModeActive.resize(aEngine.mpTables->GetModesNumber());
 }
 
-void ModalStiffStringProcessor::InitializeInModes()
+void ModalStiffStringProcessor::InitializeModes(Engine& aEngine)
 {
-    mModesIn.resize(2);
-    mModesIn = std::vector<std::vector<float>>(2, std::vector<float>(mModesNumber, 0));
+    //The engine is not rendered yet, the first mode shapes are read at once
+    RecomputeInModes();
+    RecomputeOutModes();
+    aEngine.mModesIn.Acquire();
+    aEngine.mModesOut.Acquire();
+}
 
-    mpModesInCurr.store(&mModesIn[0][0]);
-    mpModesInNew.store(&mModesIn[1][0]);
+void ModalStiffStringProcessor::PublishEngine(std::shared_ptr<const ModalStringTables> apTables, bool aKeepsStates, int aPickupsNumber)
+{
+    ReleaseRetiredEngines();
 
-    RecomputeInModes();
+    //The positions follow the string length, the previous engines keep theirs
+    float vOldLength = mLength;
+    mLength = apTables->GetLength();
+    mExcitPos *= mLength / vOldLength;
+    for (float& vReadPos : mReadPos)
+    {
+        vReadPos *= mLength / vOldLength;
+    }
+
+    mEngines.push_back(std::make_unique<Engine>());
+    Engine* vpEngine = mEngines.back().get();
+    vpEngine->mpTables = std::move(apTables);
+    vpEngine->mKeepsStates = aKeepsStates;
+    vpEngine->mPickupsNumber = aPickupsNumber;
+    AllocateEngine(*vpEngine);
+    mpEditedEngine = vpEngine;
+    InitializeModes(*vpEngine);
+
+    //An engine replaced before the audio thread adopted it was never used
+    Engine* vpSkipped = mpPendingEngine.exchange(vpEngine, std::memory_order_acq_rel);
+    if (vpSkipped)
+    {
+        mEngines.erase(std::find_if(mEngines.begin(), mEngines.end(),
+            [vpSkipped](const std::unique_ptr<Engine>& apEngine) { return apEngine.get() == vpSkipped; }));
+    }
+}
+
+void ModalStiffStringProcessor::ReleaseRetiredEngines()
+{
+    Engine* vpRetired = nullptr;
+    while (mRetiredEngines.Pop(vpRetired))
+    {
+        mEngines.erase(std::find_if(mEngines.begin(), mEngines.end(),
+            [vpRetired](const std::unique_ptr<Engine>& apEngine) { return apEngine.get() == vpRetired; }));
+    }
 }
 
-void ModalStiffStringProcessor::InitializeOutModes()
+void ModalStiffStringProcessor::AdoptPendingEngine()
 {
-    mModesOut.resize(2);
-    mModesOut = std::vector<std::vector<float>>(2, std::vector<float>(mModesNumber, 0));
+    if (mIsResetPending.load(std::memory_order_relaxed) && mIsResetPending.exchange(false, std::memory_order_acquire))
+    {
+        InitializeStates();
+    }
+
+    if (mpPendingEngine.load(std::memory_order_relaxed) == nullptr)
+    {
+        return;
+    }
+    Engine* vpEngine = mpPendingEngine.exchange(nullptr, std::memory_order_acq_rel);
+    if (!vpEngine)
+    {
+        return;
+    }
 
-    mpModesOutCurr.store(&mModesOut[0][0]);
-    mpModesOutNew.store(&mModesOut[1][0]);
+    //Same string at another time step or with other pickups, same modes
+    if (vpEngine->mKeepsStates)
+    {
+        int vModesNumber = std::min(mModesNumber, vpEngine->mpTables->GetModesNumber());
+        std::copy(mpDispl, mpDispl + vModesNumber, vpEngine->mpDispl);
+        std::copy(mpVel, mpVel + vModesNumber, vpEngine->mpVel);
+    }
 
-    RecomputeOutModes();
+    //At most one engine is retired per engine published, the queue has room
+    Engine* vpRetired = mpEngine;
+    mpEngine = vpEngine;
+    BindEngine();
+    mRetiredEngines.Push(vpRetired);
 }
 
-void ModalStiffStringProcessor::RecomputeInModes()
+void ModalStiffStringProcessor::BindEngine()
 {
-    //Computing new modes offline on another thread
-    for (int i = 0; i < mModesNumber; ++i)
+    mpTables = mpEngine->mpTables;
+    mTimeStep = mpTables->GetTimeStep();
+    mOversamplingFactor = mpTables->GetOversamplingFactor();
+    mModesNumber = mpTables->GetModesNumber();
+    mModesStride = mpTables->GetModesStride();
+    mPickupsNumber = mpEngine->mPickupsNumber;
+
+    mpEigenFreqs = mpTables->GetEigenFreqs();
+    mpDampCoeffs = mpTables->GetDampCoeffs();
+    mpInvSchurComp = mpTables->GetInvSchurComp();
+    mpVelDisplCoeffs = mpTables->GetVelDisplCoeffs();
+    mpVelVelCoeffs = mpTables->GetVelVelCoeffs();
+    mpDecayM11 = mpTables->GetDecayM11();
+    mpDecayM12 = mpTables->GetDecayM12();
+    mpDecayM21 = mpTables->GetDecayM21();
+    mpDecayM22 = mpTables->GetDecayM22();
+
+    mpDispl = mpEngine->mpDispl;
+    mpVel = mpEngine->mpVel;
+
+    float* vpArray = mpEngine->mpSlotArrays;
+    auto vNextArray = [&vpArray, this](int aArraysNumber)
     {
-        mpModesInNew.load()[i] = ComputeMode(mExcitPos, i + 1);
+        float* vpStart = vpArray;
+        vpArray += aArraysNumber * mModesStride;
+        return vpStart;
+    };
+    for (float** vppArray : { &mpSlotVelDisplCoeffs, &mpSlotVelVelCoeffs,
+        &mpSlotDecayM11, &mpSlotDecayM12, &mpSlotDecayM21, &mpSlotDecayM22 })
+    {
+        *vppArray = vNextArray(1);
+    }
+    mpSlotModesIn = vNextArray(2);
+    mpSlotModesOut = vNextArray(mPickupsNumber);
+    mpSlotDispl = vNextArray(1);
+    mpSlotVel = vNextArray(1);
+    mpSlotModesInStep = vNextArray(2);
+    mpSlotModesOutStep = vNextArray(mPickupsNumber);
+    for (float** vppArray : { &mpSlotModesInQuad, &mpSlotRotationCos, &mpSlotRotationSin, &mpSlotInvSchurComp })
+    {
+        *vppArray = vNextArray(1);
+    }
+    mpModulatedModesIn = vNextArray(2);
+    mpModulatedModesInQuad = vNextArray(1);
+    mpModulatedRotationCos = vNextArray(1);
+    mpModulatedRotationSin = vNextArray(1);
+
+    mpFreeVel = vNextArray(1);
+    assert(vpArray == mpEngine->mArena.GetData() + mpEngine->mArena.GetSize());
+
+    mpActiveModes = mpEngine->mActiveModes.data();
+    mpIsModeActive = mpEngine->mIsModeActive.data();
+    mIsInputModulated = false;
+    ResetActiveModes();
+    if (!mpEngine->mKeepsStates)
+    {
+        InitializeStates();
     }
-    //Atomic pointers switch allows to change position online
-    auto vpModesPtr = mpModesInCurr.load();
-    mpModesInCurr.store(mpModesInNew.load());
-    mpModesInNew.store(vpModesPtr);
+}
+
+void ModalStiffStringProcessor::RecomputeInModes()
+{
+    //Computing new modes offline on another thread
+    Engine& vEngine = *mpEditedEngine;
+    const ModalStringTables& vTables = *vEngine.mpTables;
+    ComputeModesIn(vTables, mExcitPos, vEngine.mpModesInBuffers[vEngine.mModesIn.GetWriteIndex()]);
+    //The audio thread crossfades to the last mode shapes published at its next block
+    vEngine.mModesIn.Publish();
 }
 
 void ModalStiffStringProcessor::RecomputeOutModes()
 {
     //Computing new modes offline on another thread
-    for (int i = 0; i < mModesNumber; ++i)
+    //The write buffer holds older mode shapes, so every pickup is computed
+    Engine& vEngine = *mpEditedEngine;
+    const ModalStringTables& vTables = *vEngine.mpTables;
+    auto vpModesOut = vEngine.mpModesOutBuffers[vEngine.mModesOut.GetWriteIndex()];
+    for (int k = 0; k < vEngine.mPickupsNumber; ++k)
     {
-        mpModesOutNew.load()[i] = ComputeMode(mReadPos, i + 1);
+        ComputeModesOut(vTables, mReadPos[k], vpModesOut + k * vTables.GetModesStride());
     }
-    //Atomic pointers switch allows to change position online
-    auto vpModesPtr = mpModesOutCurr.load();
-    mpModesOutCurr.store(mpModesOutNew.load());
-    mpModesOutNew.store(vpModesPtr);
+    vEngine.mModesOut.Publish();
 }
 
-void ModalStiffStringProcessor::RecomputeDampProfile()
+void ModalStiffStringProcessor::InitializeStates()
+{
+    std::fill(mpDispl, mpDispl + mModesStride, 0.f);
+    std::fill(mpVel, mpVel + mModesStride, 0.f);
+    mIsAtRest = true;
+}
+
+void ModalStiffStringProcessor::ResetActiveModes()
 {
-    mDampCoeffs.resize(mModesNumber);
     for (int i = 0; i < mModesNumber; ++i)
     {
-        auto vFreq = mEigenFreqs[i];
-        mDampCoeffs[i] = - ComputeDampCoeff(vFreq);
+        mpActiveModes[i] = i;
+        mpIsModeActive[i] = true;
     }
+    mActiveModesNumber = mModesNumber;
+    ++mTablesVersion;
 }
 
-void ModalStiffStringProcessor::InitializeStates()
+void ModalStiffStringProcessor::GatherWorkingSet(const float* apModesIn, const float* apModesOut)
 {
-    // Initialise xVectors
-    mStates.resize(2);
-    mpStatesPtrs.resize(2);
-    // initialise states container with two vectors of 0s
-    mStates = std::vector<std::vector<float>>(2, std::vector<float>(mModesNumber * 2, 0));
-    mpStatesPtrs = std::vector<float*>(2, nullptr);
-    // initialise pointers to state vectors
-    for (int i = 0; i < 2; ++i)
+    const float* const vpModesInSchur = apModesIn + mModesStride;
+    float* const vpSlotModesInSchur = mpSlotModesIn + mModesStride;
+    for (int s = 0; s < mActiveModesNumber; ++s)
     {
-        mpStatesPtrs[i] = &mStates[i][0];
+        int i = mpActiveModes[s];
+        mpSlotVelDisplCoeffs[s] = mpVelDisplCoeffs[i];
+        mpSlotVelVelCoeffs[s] = mpVelVelCoeffs[i];
+        mpSlotDecayM11[s] = mpDecayM11[i];
+        mpSlotDecayM12[s] = mpDecayM12[i];
+        mpSlotDecayM21[s] = mpDecayM21[i];
+        mpSlotDecayM22[s] = mpDecayM22[i];
+        mpSlotModesIn[s] = apModesIn[i];
+        vpSlotModesInSchur[s] = vpModesInSchur[i];
+        mpSlotInvSchurComp[s] = mpInvSchurComp[i];
+    }
+    for (int k = 0; k < mPickupsNumber; ++k)
+    {
+        const float* const vpModesOut = apModesOut + k * mModesStride;
+        float* const vpSlotModesOut = mpSlotModesOut + k * mModesStride;
+        for (int s = 0; s < mActiveModesNumber; ++s)
+        {
+            vpSlotModesOut[s] = vpModesOut[mpActiveModes[s]];
+        }
     }
 }
 
-void ModalStiffStringProcessor::ResetMatrices()
+void ModalStiffStringProcessor::PrepareModesRamp(const float* apModesIn, const float* apModesOut, int aStepsNumber)
 {
-    mT11.resize(mModesNumber);
-    mT12.resize(mModesNumber);
-    mT21.resize(mModesNumber);
-    mT22.resize(mModesNumber);
-    mSchurComp.resize(mModesNumber);
-
-    mB11.resize(mModesNumber);
-    mB12.resize(mModesNumber);
-    mB21.resize(mModesNumber);
-    mB22.resize(mModesNumber);
+    const float vInvStepsNumber = 1.f / static_cast<float>(aStepsNumber);
+    const float* const vpModesInSchur = apModesIn + mModesStride;
+    const float* const vpSlotModesInSchur = mpSlotModesIn + mModesStride;
+    float* const vpSlotModesInSchurStep = mpSlotModesInStep + mModesStride;
+    for (int s = 0; s < mActiveModesNumber; ++s)
+    {
+        int i = mpActiveModes[s];
+        mpSlotModesInStep[s] = (apModesIn[i] - mpSlotModesIn[s]) * vInvStepsNumber;
+        vpSlotModesInSchurStep[s] = (vpModesInSchur[i] - vpSlotModesInSchur[s]) * vInvStepsNumber;
+    }
+    for (int k = 0; k < mPickupsNumber; ++k)
+    {
+        const float* const vpModesOut = apModesOut + k * mModesStride;
+        const float* const vpSlotModesOut = mpSlotModesOut + k * mModesStride;
+        float* const vpSlotModesOutStep = mpSlotModesOutStep + k * mModesStride;
+        for (int s = 0; s < mActiveModesNumber; ++s)
+        {
+            vpSlotModesOutStep[s] = (vpModesOut[mpActiveModes[s]] - vpSlotModesOut[s]) * vInvStepsNumber;
+        }
+    }
+}
 
-    mZeta2.resize(mModesNumber);
-    mB1.resize(mModesNumber);
-    mB2.resize(mModesNumber);
+void ModalStiffStringProcessor::PrepareModesRotation(float aPos, float aStepAngle)
+{
+    ModeShapes::ComputeRotatingHarmonics(Global::kPi * aPos, std::sqrt(2.0 / mpTables->GetLength()), aStepAngle,
+        mpModulatedModesIn, mpModulatedModesInQuad, mpModulatedRotationCos, mpModulatedRotationSin, mModesNumber);
 
-    mZ1.resize(mModesNumber);
-    mInvAv2.resize(mModesNumber);
-    mInvAv1.resize(mModesNumber);
+    float* const vpSlotModesInSchur = mpSlotModesIn + mModesStride;
+    for (int s = 0; s < mActiveModesNumber; ++s)
+    {
+        int i = mpActiveModes[s];
+        mpSlotModesIn[s] = mpModulatedModesIn[i];
+        vpSlotModesInSchur[s] = mpModulatedModesIn[i] * mpInvSchurComp[i];
+        mpSlotModesInQuad[s] = mpModulatedModesInQuad[i];
+        mpSlotRotationCos[s] = mpModulatedRotationCos[i];
+        mpSlotRotationSin[s] = mpModulatedRotationSin[i];
+    }
+}
 
-    mY2.resize(mModesNumber);
-    mZ2.resize(mModesNumber);
-    mInvAb2.resize(mModesNumber);
-    mInvAb1.resize(mModesNumber);
+void ModalStiffStringProcessor::ComputeModulatedModes(float aPos)
+{
+    const float vLength = mpTables->GetLength();
+    ModeShapes::Compute(aPos * vLength, vLength, mpModulatedModesIn, mModesNumber);
+    float* const vpModulatedModesInSchur = mpModulatedModesIn + mModesStride;
+    for (int i = 0; i < mModesNumber; ++i)
+    {
+        vpModulatedModesInSchur[i] = mpModulatedModesIn[i] * mpInvSchurComp[i];
+    }
+}
 
+void ModalStiffStringProcessor::UpdateActiveModes(const float* apModesIn, const float* apModesOut, float aBowTermsSum)
+{
+    const float* const vpModesInSchur = apModesIn + mModesStride;
+    const float vThreshold = mModeEnergyThreshold.load();
+    int vActiveModesNumber = 0;
+    bool vHasChanged = false;
     for (int i = 0; i < mModesNumber; ++i)
     {
-        mT11[i] = 1;
-        mT12[i] = - 0.5f * mTimeStep;
-        mT21[i] = - 0.5f * mTimeStep * (-mEigenFreqs[i] * mEigenFreqs[i]);
-        mT22[i] = 1;
+        //The bow term f adds g * f to the velocity at each step, so the velocity
+        //given to a mode during the block is at most g * sum(|f|)
+        float vBowVel = vpModesInSchur[i] * aBowTermsSum;
+        bool vIsExcited = 0.5f * vBowVel * vBowVel >= vThreshold;
+
+        //Modes culled at the bow and every pickup neither interact with the
+        //bow nor reach the outputs
+        bool vIsCulled = apModesIn[i] == 0.f;
+        for (int k = 0; vIsCulled && k < mPickupsNumber; ++k)
+        {
+            vIsCulled = apModesOut[k * mModesStride + i] == 0.f;
+        }
 
-        mSchurComp[i] = mT22[i] - mT21[i] * (mT11[i] * mT12[i]);
+        bool vIsActive = vIsExcited && !vIsCulled;
+        if (vIsCulled)
+        {
+            mpDispl[i] = 0.f;
+            mpVel[i] = 0.f;
+        }
+        else if (!vIsExcited && mpIsModeActive[i])
+        {
+            float vOmegaDispl = mpEigenFreqs[i] * mpDispl[i];
+            float vEnergy = 0.5f * (vOmegaDispl * vOmegaDispl + mpVel[i] * mpVel[i]);
+            vIsActive = vEnergy >= vThreshold;
+            if (!vIsActive)
+            {
+                mpDispl[i] = 0.f;
+                mpVel[i] = 0.f;
+            }
+        }
+
+        if (vIsActive != mpIsModeActive[i])
+        {
+            mpIsModeActive[i] = vIsActive;
+            vHasChanged = true;
+        }
+        if (vIsActive)
+        {
+            mpActiveModes[vActiveModesNumber++] = i;
+        }
+    }
 
-        mB11[i] = 1;
-        mB12[i] = 0.5f * mTimeStep;
-        mB21[i] = 0.5 * mTimeStep * (-mEigenFreqs[i] * mEigenFreqs[i]);
-        mB22[i] = 1 - mTimeStep*mDampCoeffs[i];
+    if (vHasChanged)
+    {
+        mActiveModesNumber = vActiveModesNumber;
+        ++mTablesVersion;
     }
 }
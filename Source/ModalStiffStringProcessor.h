@@ -10,53 +10,152 @@
 
 #pragma once
 
-#include <JuceHeader.h>
+#include <atomic>
+#include <memory>
+#include <vector>
 #include "Global.h"
-
-class ModalStiffStringProcessor
+#include "BowFriction.h"
+#include "ModalKernels.h"
+#include "AlignedArena.h"
+#include "CommandQueue.h"
+#include "TripleBuffer.h"
+#include "ModalStringEngine.h"
+#include "ModalStringTables.h"
+
+class ModalStiffStringProcessor : public ModalStringEngine
 {
 public:
     //==========================================================================
     ModalStiffStringProcessor(double aSampleRate, Global::Strings::String* apString);
-    ~ModalStiffStringProcessor();
+
+    //Renders the string of apTables, whose coefficients are shared and not copied
+    explicit ModalStiffStringProcessor(std::shared_ptr<const ModalStringTables> apTables);
+    ~ModalStiffStringProcessor() override;
+
+    ModalStiffStringProcessor(const ModalStiffStringProcessor&) = delete;
+    ModalStiffStringProcessor& operator=(const ModalStiffStringProcessor&) = delete;
 
     //==========================================================================
-    //Set the time sampling step, to be called inside the PrepareToPlay
+    /*
+    Set the time sampling step, e.g. inside the PrepareToPlay. The tables of
+    the new step are built by the calling thread and adopted by the audio
+    thread at its next block, keeping the string states, see SetString.
+    */
     void SetTimeStep(double aTimeStep);
 
     /*
     Play or pause the sound. If the sound is paused the state is not computed, 
     but the string is not reset.
     */
-    void SetPlayState(bool aPlayState);
+    void SetPlayState(bool aPlayState) override;
 
     /*
     Resets the string states, setting each oscillator to zero.
-    If the PlayState is true it is set to false
+    If the PlayState is true it is set to false.
+    Safe from any thread, the audio thread applies the reset at the start of its next block
     */
-    void ResetStringStates();
+    void ResetStringStates() override;
 
     //Recomputes the mode for the input location at runtime
-    void SetInputPos(float aNewPos);
+    void SetInputPos(float aNewPos) override;
+
+    //Recomputes the mode for the output location at runtime, i.e. of the first pickup
+    void SetReadPos(float aNewPos) override;
+
+    /*
+    Sets the number of pickups read at once by the multichannel ProcessBlock,
+    from 1 to kMaxPickups, each with its own read position. Like SetString the
+    calling thread builds the buffers and the audio thread adopts them at its
+    next block, keeping the string states. The pickups added take the read
+    position of the first one.
+    */
+    void SetPickupsNumber(int aPickupsNumber);
+
+    //Returns the number of pickups of the last SetPickupsNumber
+    int GetPickupsNumber();
+
+    //Recomputes the output modes of the pickup aPickup at runtime, SetReadPos for the first one
+    void SetPickupPos(int aPickup, float aNewPos);
+
+    /*
+    Sets the read position of the first pickup and places the others from it,
+    recomputing the output modes once: each odd pickup mirrors the even one
+    before it about the middle of the string, and each pair is shifted by
+    1 / GetPickupsNumber() of the string from the previous one. With two
+    pickups, e.g. in stereo, the second one reads at 1 - aNewPos.
+    */
+    void SetPickupsReadPos(float aNewPos);
 
-    //Recomputes the mode for the output location at runtime
-    void SetReadPos(float aNewPos);
+    //Returns the read position of the first pickup, in normalized percentage of string length
+    float GetReadPos();
 
     //Sets the gain to be multiplied to the output value
-    void SetGain(float aGain);
+    void SetGain(float aGain) override;
 
     //Sets the bowing pressure Fb at runtime
-    void SetBowPressure(float aPressure);
+    void SetBowPressure(float aPressure) override;
 
     //Sets the bowing speed Vb at runtime
-    void SetBowSpeed(float aSpeed);
+    void SetBowSpeed(float aSpeed) override;
 
     /*
-    Change the string being played.This stops the 
-    playback and recomputes all the string matrices
+    Change the string being played, from any thread but the audio one. The
+    calling thread builds the tables, the mode shapes and the buffers of the
+    new string, and the audio thread switches to them at the start of its next
+    block without allocating nor waiting. The new string starts at rest and the
+    play state is kept. The input and output positions are kept relative to
+    the string length.
     */
     void SetString(Global::Strings::String* apString);
 
+    /*
+    Change the string being played to the one of apTables, which may be shared
+    with other processors, e.g. by the audio thread itself. Unlike SetString
+    this stops the playback and resets the states at once, and nothing is
+    allocated if the new string has no more modes than the largest one used
+    so far. Not to be mixed with SetString or SetTimeStep from other threads.
+    */
+    void SetTables(std::shared_ptr<const ModalStringTables> apTables);
+
+    /*
+    Mode shapes of a string at one input and one read position, computed ahead
+    of time, e.g. for each note of a voice pool, in the layout of the engine
+    */
+    struct StringModes
+    {
+        std::shared_ptr<const ModalStringTables> mpTables;
+        std::vector<float> mModesIn;    //[w | g], two arrays of the modes stride
+        std::vector<float> mModesOut;   //o of a single pickup
+        float mInputPos{ 0.f };         //In normalized percentage of string length
+        float mReadPos{ 0.f };
+    };
+
+    /*
+    Computes the mode shapes of aModes.mpTables at the positions in normalized
+    percentage of string length, culled with the node weight threshold of this
+    processor. Nothing is allocated once aModes has been computed. Safe from
+    any thread while the threshold is not changed.
+    */
+    void ComputeStringModes(StringModes& aModes, float aInputPos, float aReadPos) const;
+
+    /*
+    Same as SetTables, with the mode shapes of aModes copied instead of
+    computed, so that only the pointers are switched and the states cleared.
+    The positions of aModes become the input and read positions, for a
+    processor with a single pickup.
+    */
+    void SetTables(const StringModes& aModes);
+
+    /*
+    Same as SetInputPos and SetReadPos, with the mode shapes of aModes copied
+    instead of computed. aModes must be computed for the tables of the last
+    SetTables, for a processor with a single pickup.
+    */
+    void SetModes(const StringModes& aModes);
+
+    //Returns the coefficient tables of the last string set
+    std::shared_ptr<const ModalStringTables> GetTables();
+
     /*
     Calculates the next string state. 
     To be called for each sample inside the audio process
@@ -66,8 +165,115 @@ public:
     //Returns the output value at the output location
     float ReadOutput();
 
+    /*
+    Computes aNumSamples new string states and writes the output value at the
+    output location in apOutput, equivalent to calling ComputeState() followed
+    by ReadOutput() for each sample. Play state, bow params, gain and modes
+    tables are read once at the beginning of the block, so changes coming from
+    other threads are applied at block boundaries.
+    Returns false if the block is silent, i.e. the string is paused or
+    sleeping, in which case apOutput is filled with zeros.
+    */
+    bool ProcessBlock(float* apOutput, int aNumSamples) override;
+
+    /*
+    Renders like ProcessBlock with the bow moving along the string, at
+    apInputPos[n] for the sample n, in normalized percentage of string length.
+    The input mode shapes are computed exactly every kModulationStep samples
+    and turned by a rotation of each mode at every step in between, inside
+    the state update, so that the bow follows the positions linearly between
+    them without a sine per mode and sample. Node culling does not apply to the
+    moving bow. The first block rendered without modulation crossfades back
+    to the position of SetInputPos. Audio thread.
+    */
+    bool ProcessBlock(float* apOutput, int aNumSamples, const float* apInputPos);
+
+    //Same, with the bow moving linearly from aStartPos at the first sample to aEndPos at the last one
+    bool ProcessBlock(float* apOutput, int aNumSamples, float aStartPos, float aEndPos);
+
+    /*
+    Renders like ProcessBlock the outputs of the first aOutputsNumber pickups,
+    in apOutputs[k] for the pickup k. The pickups are read together while the
+    states are written, so each one costs a multiply-add per mode and sample
+    instead of a whole string. Outputs beyond the pickups of the string are
+    filled with zeros. Audio thread.
+    */
+    bool ProcessBlock(float* const* apOutputs, int aOutputsNumber, int aNumSamples);
+
+    /*
+    Sets the modal energy below which an unbowed string goes to sleep. At the
+    end of each block rendered by ProcessBlock without bow, the energy is
+    compared against the floor: if lower, the states are set to zero and the
+    following blocks are skipped until the bow pressure is nonzero again.
+    A floor of zero disables sleeping.
+    */
+    void SetSleepEnergyFloor(float aEnergyFloor) override;
+
+    //Returns true if the string has decayed below the energy floor
+    bool IsSleeping();
+
+    //Returns the modal energy of the string, to be called by the audio thread
+    float GetEnergy();
+
+    /*
+    Sets the energy below which a mode is dropped from the per-sample update.
+    At the end of each block a mode leaves the active set if its energy
+    (w q)^2 / 2 + p^2 / 2 has decayed below the threshold and the bow terms of
+    the block could not have given it more than that. Dropped modes are set to
+    zero and come back as soon as the bow can excite them. A threshold of zero
+    keeps every mode active, except those culled by SetNodeWeightThreshold.
+    */
+    void SetModeEnergyThreshold(float aThreshold);
+
+    //Returns the number of modes updated in the last block
+    int GetActiveModesNumber();
+
+    /*
+    Sets the relative weight below which a mode shape at the input or output
+    location is treated as a node. A mode with a node at the bow is zeroed in
+    the input modes, so it is neither excited nor felt by the bow. A mode with
+    a node at a pickup is zeroed in its output modes. Modes with a node at the
+    bow and every pickup are removed from the active set at the end of the
+    block. The weight is
+    relative to the peak of the mode shapes, a threshold of zero disables the
+    culling. Input and output modes are recomputed.
+    */
+    void SetNodeWeightThreshold(float aThreshold);
+
+    /*
+    Enables the crossfade of the mode shapes when the input or read position
+    changes while the string sounds, over the next block. When disabled the
+    new shapes are taken at the start of the block. Enabled by default.
+    */
+    void SetModesCrossfade(bool aIsEnabled);
+
+    //Samples between the exact input mode shapes of a moving bow
+    static constexpr int kModulationStep = 32;
+
+    static constexpr int kMaxPickups = ModalKernels::kMaxPickups;
+
+    /*
+    Selects the instruction set used by ProcessBlock. The best one supported
+    by the CPU is selected at construction, the scalar kernel is the reference
+    implementation. Returns false and keeps the current kernel if aIsa is not
+    supported. Not to be called while the audio thread is processing.
+    */
+    bool SetKernelIsa(ModalKernels::Isa aIsa);
+
+    //Returns the instruction set used by ProcessBlock
+    ModalKernels::Isa GetKernelIsa();
+
+    /*
+    Selects how the bow friction terms are evaluated at each step, see
+    BowFriction.h. The exact one is the default. Not to be called while the
+    audio thread is processing.
+    */
+    void SetFrictionAccuracy(BowFriction::Accuracy aAccuracy);
+
+    BowFriction::Accuracy GetFrictionAccuracy();
+
     //Return the modes number
-    int GetModesNumber();
+    int GetModesNumber() override;
 
     /*
     Take in input a vector (by reference!), empty it and fill it with the mode
@@ -85,31 +291,75 @@ public:
 
 private:
     //==========================================================================
-    Global::Strings::String* mpString;
+    //Bow positions of a block, the buffer if given or else the linear ramp
+    struct InputPosModulation
+    {
+        const float* mpPositions;
+        float mStartPos;
+        float mEndPos;
+
+        //Position at aSample of aNumSamples, in normalized percentage of string length
+        float GetPos(int aSample, int aNumSamples) const;
+    };
+
+    /*
+    Tables of one string at one time step with the arena and the active set
+    sized for them, see mArena below. SetString and SetTimeStep build a whole
+    new engine and publish it in mpPendingEngine, the audio thread adopts it at
+    the start of its next block by binding its pointers, and hands the previous
+    one back through mRetiredEngines. The engines are owned by mEngines and
+    only freed by the other threads, once retired.
+    */
+    struct Engine
+    {
+        std::shared_ptr<const ModalStringTables> mpTables;
+        AlignedArena mArena;
+
+        float* mpModesInBuffers[3]{ nullptr, nullptr, nullptr };
+        TripleBuffer mModesIn;
+
+        float* mpModesOutBuffers[3]{ nullptr, nullptr, nullptr };
+        TripleBuffer mModesOut;
+        int mPickupsNumber{ 1 };
+
+        float* mpDispl{ nullptr };
+        float* mpVel{ nullptr };
+        float* mpSlotArrays{ nullptr };
+
+        std::vector<int> mActiveModes;
+        std::vector<unsigned char> mIsModeActive;
+
+        //States of the previous engine to be copied on adoption, for a new time
+        //step or number of pickups
+        bool mKeepsStates{ false };
+    };
+
+    //Engine written by SetInputPos and SetReadPos, the last one built
+    Engine* mpEditedEngine{ nullptr };
+
+    //Engine rendered by the audio thread
+    Engine* mpEngine{ nullptr };
+
+    std::atomic<Engine*> mpPendingEngine{ nullptr };
+    CommandQueue<Engine*> mRetiredEngines{ 8 };
+    std::vector<std::unique_ptr<Engine>> mEngines;
+
+    //Constant coefficients of the string at the current time step
+    std::shared_ptr<const ModalStringTables> mpTables;
 
     //PlayState
     std::atomic<bool> mPlayState{ false };
+    std::atomic<bool> mIsResetPending{ false };
     std::atomic<float> mGain{ 0.f };
 
+    //Sleep state, see SetSleepEnergyFloor
+    std::atomic<float> mSleepEnergyFloor{ 1e-12f };
+    std::atomic<bool> mIsSleeping{ false };
+
     //String params
-    float mRadius{ 0.f };
-    float mDensity{ 0.f };
-    float mTension{ 0.f };
-    float mArea{ 0.f };
-    float mLinDensity{ 0.f };
-    float mC{ 0.f };
-    float mYoungMod{ 0.f };
-    float mInertia{ 0.f };
-    float mK{ 0.f };
     float mLength{ 0.f };
     float mExcitPos{ 0.f };
-    float mReadPos{ 0.f };
-    std::vector<float> mDampCoeffs;
-
-    //==========================================================================
-    //String states
-    std::vector<std::vector<float>> mStates;
-    std::vector<float*> mpStatesPtrs;
+    float mReadPos[kMaxPickups]{};
 
     //==========================================================================
     //Bow params
@@ -117,62 +367,204 @@ private:
     std::atomic<float> mVb;
     float mA{ 0.f };
 
+    //Friction characteristic for mA
+    BowFriction::Evaluator mFriction{ 0.f };
+
     //==========================================================================
     //FDS & Modal params
     int mOversamplingFactor{ 0 };
     double mTimeStep{ 0.0 };
     int mModesNumber{ 0 };
-    std::vector<float> mEigenFreqs;
+    int mPickupsNumber{ 1 };
 
-    std::vector<std::vector<float>> mModesIn;
-    std::atomic<float*> mpModesInCurr;
-    std::atomic<float*> mpModesInNew;
+    /*
+    The constant coefficients are read from mpTables, the tables of mpEngine
+        mpEigenFreqs, mpDampCoeffs
+        mpInvSchurComp                      1 / Schur complement of the A block
+        mpVelDisplCoeffs, mpVelVelCoeffs    free response of the velocity
+        mpDecayM11, mpDecayM12,             free decay over one output sample,
+        mpDecayM21, mpDecayM22              used while the bow is not in contact
+
+    All the other per-mode arrays live in a single 64-byte aligned arena of
+    mpEngine, laid out as a structure of arrays. Every array is mModesStride
+    floats long, i.e. the modes number rounded up to a whole cache line, and
+    its padding is zero. In order of position inside the arena:
+
+    Mode shapes at the input and output locations, triple buffered so that they
+    can be recomputed at any rate while the audio thread reads them. Each input
+    buffer holds the mode shapes w followed by g = w / SchurComp, each output
+    buffer the mode shapes o of each of the mPickupsNumber pickups
+        mpModesInBuffers[3] -> [w | g], mpModesOutBuffers[3] -> [o_0 | o_1 | ...]
+
+    String states, in modes order
+        mpDispl, mpVel
+
+    Working set of the active modes only, compacted in slot order, i.e. slot s
+    holds the mode mActiveModes[s]. The coefficients and mode shapes are
+    gathered when the active set or the tables change, the states are gathered
+    at the beginning of each block and scattered back at its end. The kernels
+    only see these arrays.
+        mpSlotVelDisplCoeffs, mpSlotVelVelCoeffs
+        mpSlotDecayM11, mpSlotDecayM12, mpSlotDecayM21, mpSlotDecayM22
+        mpSlotModesIn -> [w | g], mpSlotModesOut -> [o_0 | o_1 | ...]
+        mpSlotDispl, mpSlotVel
+
+    Steps of the mode shapes in slot order, while crossfading to new ones
+        mpSlotModesInStep -> [w | g], mpSlotModesOutStep -> [o_0 | o_1 | ...]
+
+    Moving bow, in slot order: the quadrature c of the input mode shapes, the
+    rotation of each mode at each step, see ModalKernels::ModesRotationArgs,
+    and the inverse Schur complements to recompute g
+        mpSlotModesInQuad, mpSlotRotationCos, mpSlotRotationSin, mpSlotInvSchurComp
+
+    Moving bow, in modes order: the input mode shapes at the last position of
+    the last modulated block, and the values gathered into the slots above
+        mpModulatedModesIn -> [w | g], mpModulatedModesInQuad,
+        mpModulatedRotationCos, mpModulatedRotationSin
+
+    Scratch in slot order, written and read within the same sample
+        mpFreeVel
+    */
+    int mModesStride{ 0 };
 
-    std::vector<std::vector<float>> mModesOut;
-    std::atomic<float*> mpModesOutCurr;
-    std::atomic<float*> mpModesOutNew;
+    const float* mpEigenFreqs{ nullptr };
+    const float* mpDampCoeffs{ nullptr };
 
-    std::vector<int> mT11;
-    std::vector<float> mT12;
-    std::vector<float> mT21;
-    std::vector<int> mT22;
+    const float* mpInvSchurComp{ nullptr };
+    const float* mpVelDisplCoeffs{ nullptr };
+    const float* mpVelVelCoeffs{ nullptr };
 
-    std::vector<float> mSchurComp;
+    const float* mpDecayM11{ nullptr };
+    const float* mpDecayM12{ nullptr };
+    const float* mpDecayM21{ nullptr };
+    const float* mpDecayM22{ nullptr };
 
-    std::vector<int> mB11;
-    std::vector<float> mB12;
-    std::vector<float> mB21;
-    std::vector<float> mB22;
+    //String states
+    float* mpDispl{ nullptr };
+    float* mpVel{ nullptr };
+
+    //Active modes working set
+    float* mpSlotVelDisplCoeffs{ nullptr };
+    float* mpSlotVelVelCoeffs{ nullptr };
+    float* mpSlotDecayM11{ nullptr };
+    float* mpSlotDecayM12{ nullptr };
+    float* mpSlotDecayM21{ nullptr };
+    float* mpSlotDecayM22{ nullptr };
+    float* mpSlotModesIn{ nullptr };
+    float* mpSlotModesOut{ nullptr };
+    float* mpSlotDispl{ nullptr };
+    float* mpSlotVel{ nullptr };
+    float* mpSlotModesInStep{ nullptr };
+    float* mpSlotModesOutStep{ nullptr };
+    float* mpSlotModesInQuad{ nullptr };
+    float* mpSlotRotationCos{ nullptr };
+    float* mpSlotRotationSin{ nullptr };
+    float* mpSlotInvSchurComp{ nullptr };
+
+    float* mpModulatedModesIn{ nullptr };
+    float* mpModulatedModesInQuad{ nullptr };
+    float* mpModulatedRotationCos{ nullptr };
+    float* mpModulatedRotationSin{ nullptr };
+
+    float* mpFreeVel{ nullptr };
+
+    std::atomic<float> mModeEnergyThreshold{ 1e-12f };
+    float mNodeWeightThreshold{ 1e-3f };
+    int* mpActiveModes{ nullptr };
+    unsigned char* mpIsModeActive{ nullptr };
+    int mActiveModesNumber{ 0 };
+    bool mWasBowed{ false };
+
+    //True while the states are zero, new mode shapes are then taken at once
+    bool mIsAtRest{ true };
+
+    //True if the working set holds the input mode shapes of mpModulatedModesIn
+    bool mIsInputModulated{ false };
+    std::atomic<bool> mIsModesCrossfade{ true };
+
+    //Incremented whenever coefficients or mode shapes change, the working set
+    //is gathered again when it differs from mGatheredVersion
+    std::atomic<int> mTablesVersion{ 0 };
+    int mGatheredVersion{ -1 };
+
+    const ModalKernels::Kernel* mpKernel{ nullptr };
 
-    std::vector<float> mZeta2;
-    std::vector<float> mB1;
-    std::vector<float> mB2;
+    //==========================================================================
+    //Utility Functions
+    //Sets to zero the mode shapes of aTables below the node weight threshold
+    void CullNodeWeights(float* apModes, const ModalStringTables& aTables) const;
 
-    std::vector<float> mZ1;
-    std::vector<float> mInvAv2;
-    std::vector<float> mInvAv1;
+    //Mode shapes at the positions aPos along the string, [w | g] for the input and o for the output
+    void ComputeModesIn(const ModalStringTables& aTables, float aPos, float* apModesIn) const;
+    void ComputeModesOut(const ModalStringTables& aTables, float aPos, float* apModesOut) const;
 
-    std::vector<float> mY2;
-    std::vector<float> mZ2;
-    std::vector<float> mInvAb2;
-    std::vector<float> mInvAb1;
+    //Switches mpEditedEngine to apTables, keeping the positions relative to the length
+    void SwitchTables(std::shared_ptr<const ModalStringTables> apTables);
+
+    //Sizes the arena and the active set of aEngine for its tables
+    void AllocateEngine(Engine& aEngine);
+
+    //Computes the mode shapes of aEngine at the current positions
+    void InitializeModes(Engine& aEngine);
+
+    //Builds an engine for apTables and publishes it to the audio thread
+    void PublishEngine(std::shared_ptr<const ModalStringTables> apTables, bool aKeepsStates, int aPickupsNumber);
+
+    //Frees the engines retired by the audio thread
+    void ReleaseRetiredEngines();
+
+    //Audio thread, applies a pending reset and switches to the pending engine if there is one
+    void AdoptPendingEngine();
+
+    //Reads the time step, the modes number, the coefficients and the arrays from mpEngine
+    void BindEngine();
 
-    //==========================================================================
-    //Utility Functions
-    float ComputeEigenFreq(int aModeNumber);
-    float ComputeMode(float aPos, int aModeNumber);
-    float ComputeDampCoeff(float aFreq);
-
-    void RecomputeModesNumber();
-    void RecomputeEigenFreqs();
-    void InitializeInModes();
-    void InitializeOutModes();
     void RecomputeInModes();
     void RecomputeOutModes();
-    void RecomputeDampProfile();
 
     void InitializeStates();
-    void ResetMatrices();
 
-    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ModalStiffStringProcessor)
+    //Marks every mode as active and schedules the working set gathering
+    void ResetActiveModes();
+
+    //Copies the coefficients and mode shapes of the active modes into the working set
+    void GatherWorkingSet(const float* apModesIn, const float* apModesOut);
+
+    /*
+    Updates the active set for the next block from the states in modes order,
+    zeroing the dropped and culled modes. aBowTermsSum is the sum of the
+    magnitudes of the bow terms applied during the block, zero if it was not
+    bowed.
+    */
+    void UpdateActiveModes(const float* apModesIn, const float* apModesOut, float aBowTermsSum);
+
+    /*
+    Sets the steps from the mode shapes of the working set to those of
+    apModesIn and apModesOut over aStepsNumber steps, in slot order.
+    */
+    void PrepareModesRamp(const float* apModesIn, const float* apModesOut, int aStepsNumber);
+
+    /*
+    Sets the input mode shapes of the working set and of mpModulatedModesIn at
+    aPos, in normalized percentage of string length, and their rotation by
+    n * aStepAngle at each step, for the mode n.
+    */
+    void PrepareModesRotation(float aPos, float aStepAngle);
+
+    //Writes the input mode shapes at aPos in mpModulatedModesIn only
+    void ComputeModulatedModes(float aPos);
+
+    //ProcessBlock of aOutputsNumber pickups with the bow moving if apModulation is not null
+    bool ProcessModulatedBlock(float* const* apOutputs, int aOutputsNumber, int aNumSamples,
+        const InputPosModulation* apModulation);
+
+    /*
+    Renders aNumSamples of the first aOutputsNumber pickups with aKernel,
+    assuming the string is playing and aOutputsNumber is at most
+    mPickupsNumber. When the bow force is zero the bow terms vanish and the
+    block is rendered with the free decay kernel instead. Mode shapes
+    published since the previous block are crossfaded to over the block.
+    */
+    void RenderBlock(const ModalKernels::Kernel& aKernel, float* const* apOutputs, int aOutputsNumber, int aNumSamples,
+        const InputPosModulation* apModulation = nullptr);
 };
@@ -191,7 +191,8 @@ void ModalStiffStringView::sliderValueChanged(juce::Slider* apSlider)
 	{
 		//Value is in percentage if string length
 		auto vValue = juce::jlimit<float>(0.f, 1.f, mReadPosSlider.getValue() / 100.0);
-		mpStiffStringProcessor->SetReadPos(vValue);
+		//The pickups of the other channels follow
+		mpStiffStringProcessor->SetPickupsReadPos(vValue);
 	}
 	else if (apSlider == &mBowPressureSlider)
 	{
@@ -207,10 +208,7 @@ void ModalStiffStringView::comboBoxChanged(juce::ComboBox* comboBoxThatHasChange
 {
 	if (comboBoxThatHasChanged == &mStringChoiceBox)
 	{ 
-		if (mPlayButton.getToggleState())
-		{
-			mPlayButton.setToggleState(false, juce::sendNotification);
-		}
+		//The new string is adopted by the audio thread, playback goes on
 		if (mStringChoiceBox.getSelectedId() == Global::Strings::kpCelloA3->mId)
 		{
 			mpStiffStringProcessor->SetString(Global::Strings::kpCelloA3);
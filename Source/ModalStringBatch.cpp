@@ -0,0 +1,274 @@
+#include "ModalStringBatch.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <numeric>
+
+ModalStringBatch::ModalStringBatch(const std::vector<std::shared_ptr<const ModalStringTables>>& aStrings)
+{
+    mFriction = BowFriction::Evaluator(mA);
+    mpKernel = ModalKernels::GetKernel(ModalKernels::GetBestSupportedIsa());
+
+    mStrings.resize(aStrings.size());
+    for (size_t s = 0; s < aStrings.size(); ++s)
+    {
+        assert(aStrings[s]->GetOversamplingFactor() == 1);
+        assert(s == 0 || aStrings[s]->GetTimeStep() == aStrings[0]->GetTimeStep());
+        mStrings[s].mpTables = aStrings[s];
+    }
+    mTimeStep = aStrings.empty() ? 0.0 : aStrings[0]->GetTimeStep();
+
+    //Strings with similar modes numbers share a group, so that little is padded
+    std::vector<int> vOrder(mStrings.size());
+    std::iota(vOrder.begin(), vOrder.end(), 0);
+    std::stable_sort(vOrder.begin(), vOrder.end(), [this](int aLeft, int aRight)
+        {
+            return mStrings[aLeft].mpTables->GetModesNumber() > mStrings[aRight].mpTables->GetModesNumber();
+        });
+
+    //Resized once, the groups own their arenas and are never moved afterwards
+    mGroups.resize((mStrings.size() + kLanes - 1) / kLanes);
+    for (size_t i = 0; i < vOrder.size(); ++i)
+    {
+        auto& vString = mStrings[vOrder[i]];
+        vString.mGroup = static_cast<int>(i / kLanes);
+        vString.mLane = static_cast<int>(i % kLanes);
+    }
+
+    for (size_t g = 0; g < mGroups.size(); ++g)
+    {
+        auto& vGroup = mGroups[g];
+        std::fill(std::begin(vGroup.mStrings), std::end(vGroup.mStrings), -1);
+        //The first string of each group has the most modes
+        vGroup.mModesNumber = mStrings[vOrder[g * kLanes]].mpTables->GetModesNumber();
+
+        //8 interleaved arrays and 4 per-lane arrays
+        const std::size_t vInterleavedSize = static_cast<std::size_t>(vGroup.mModesNumber) * kLanes;
+        vGroup.mArena.Allocate(8 * vInterleavedSize + 4 * kLanes);
+
+        float* vpArray = vGroup.mArena.GetData();
+        for (float** vppArray : { &vGroup.mpVelDisplCoeffs, &vGroup.mpVelVelCoeffs,
+            &vGroup.mpModesIn, &vGroup.mpModesInSchur, &vGroup.mpModesOut,
+            &vGroup.mpDispl, &vGroup.mpVel, &vGroup.mpFreeVel })
+        {
+            *vppArray = vpArray;
+            vpArray += vInterleavedSize;
+        }
+        for (float** vppArray : { &vGroup.mpFb, &vGroup.mpVb, &vGroup.mpGain, &vGroup.mpInSchurProjection })
+        {
+            *vppArray = vpArray;
+            vpArray += kLanes;
+        }
+        assert(vpArray == vGroup.mArena.GetData() + vGroup.mArena.GetSize());
+    }
+
+    //Padding modes and lanes keep zero coefficients and stay silent
+    for (int s = 0; s < GetStringsNumber(); ++s)
+    {
+        auto& vString = mStrings[s];
+        auto& vGroup = mGroups[vString.mGroup];
+        vGroup.mStrings[vString.mLane] = s;
+
+        const auto& vTables = *vString.mpTables;
+        for (int m = 0; m < vTables.GetModesNumber(); ++m)
+        {
+            vGroup.mpVelDisplCoeffs[m * kLanes + vString.mLane] = vTables.GetVelDisplCoeffs()[m];
+            vGroup.mpVelVelCoeffs[m * kLanes + vString.mLane] = vTables.GetVelVelCoeffs()[m];
+        }
+        RecomputeInModes(vString);
+        RecomputeOutModes(vString);
+    }
+}
+
+//==========================================================================
+void ModalStringBatch::SetInputPos(int aString, float aNewPos)
+{
+    //Position is in normalized percentage of string length
+    auto& vString = mStrings[aString];
+    if (aNewPos >= 0 && aNewPos <= 1)
+    {
+        vString.mExcitPos = aNewPos * vString.mpTables->GetLength();
+    }
+    else
+    {
+        assert(false);
+    }
+    RecomputeInModes(vString);
+}
+
+void ModalStringBatch::SetReadPos(int aString, float aNewPos)
+{
+    //Position is in normalized percentage of string length
+    auto& vString = mStrings[aString];
+    if (aNewPos >= 0 && aNewPos <= 1)
+    {
+        vString.mReadPos = aNewPos * vString.mpTables->GetLength();
+    }
+    else
+    {
+        assert(false);
+    }
+    RecomputeOutModes(vString);
+}
+
+void ModalStringBatch::SetGain(int aString, float aGain)
+{
+    const auto& vString = mStrings[aString];
+    mGroups[vString.mGroup].mpGain[vString.mLane] = aGain;
+}
+
+void ModalStringBatch::SetBowPressure(int aString, float aPressure)
+{
+    const auto& vString = mStrings[aString];
+    mGroups[vString.mGroup].mpFb[vString.mLane] = aPressure;
+}
+
+void ModalStringBatch::SetBowSpeed(int aString, float aSpeed)
+{
+    const auto& vString = mStrings[aString];
+    mGroups[vString.mGroup].mpVb[vString.mLane] = aSpeed;
+}
+
+void ModalStringBatch::ResetStringStates(int aString)
+{
+    const auto& vString = mStrings[aString];
+    auto& vGroup = mGroups[vString.mGroup];
+    for (int m = 0; m < vGroup.mModesNumber; ++m)
+    {
+        vGroup.mpDispl[m * kLanes + vString.mLane] = 0.f;
+        vGroup.mpVel[m * kLanes + vString.mLane] = 0.f;
+    }
+}
+
+bool ModalStringBatch::SetKernelIsa(ModalKernels::Isa aIsa)
+{
+    if (!ModalKernels::IsSupported(aIsa))
+    {
+        return false;
+    }
+    mpKernel = ModalKernels::GetKernel(aIsa);
+    return true;
+}
+
+void ModalStringBatch::SetFrictionAccuracy(BowFriction::Accuracy aAccuracy)
+{
+    mFriction.SetAccuracy(aAccuracy);
+}
+
+int ModalStringBatch::GetPaddedModesNumber() const
+{
+    int vModesNumber = 0;
+    for (const auto& vGroup : mGroups)
+    {
+        vModesNumber += vGroup.mModesNumber * kLanes;
+    }
+    return vModesNumber;
+}
+
+void ModalStringBatch::ProcessBlock(float* const* apOutputs, int aNumSamples)
+{
+    for (auto& vGroup : mGroups)
+    {
+        RenderGroup(vGroup, apOutputs, aNumSamples);
+    }
+}
+
+//==========================================================================
+void ModalStringBatch::RecomputeInModes(const String& aString)
+{
+    const auto& vTables = *aString.mpTables;
+    auto& vGroup = mGroups[aString.mGroup];
+    float vInSchurProjection = 0.f;
+    vTables.ComputeModes(aString.mExcitPos, vGroup.mpModesIn + aString.mLane, kLanes);
+    for (int m = 0; m < vTables.GetModesNumber(); ++m)
+    {
+        const int i = m * kLanes + aString.mLane;
+        vGroup.mpModesInSchur[i] = vGroup.mpModesIn[i] * vTables.GetInvSchurComp()[m];
+        vInSchurProjection += vGroup.mpModesIn[i] * vGroup.mpModesInSchur[i];
+    }
+    vGroup.mpInSchurProjection[aString.mLane] = vInSchurProjection;
+}
+
+void ModalStringBatch::RecomputeOutModes(const String& aString)
+{
+    const auto& vTables = *aString.mpTables;
+    auto& vGroup = mGroups[aString.mGroup];
+    vTables.ComputeModes(aString.mReadPos, vGroup.mpModesOut + aString.mLane, kLanes);
+}
+
+void ModalStringBatch::RenderGroup(Group& aGroup, float* const* apOutputs, int aNumSamples)
+{
+    const auto& vKernel = *mpKernel;
+
+    //Per-lane terms, see ModalStiffStringProcessor::RenderBlock for the single string
+    alignas(64) float vHalfKFb[kLanes];
+    alignas(64) float vKFbVb[kLanes];
+    alignas(64) float vZeta1[kLanes];
+    alignas(64) float vEta[kLanes];
+    alignas(64) float vD[kLanes];
+    alignas(64) float vLambda[kLanes];
+    alignas(64) float vFreeProjection[kLanes];
+    alignas(64) float vBowTerms[kLanes];
+    alignas(64) float vOutputs[kLanes];
+
+    for (int l = 0; l < kLanes; ++l)
+    {
+        vHalfKFb[l] = static_cast<float>(0.5 * mTimeStep * aGroup.mpFb[l]);
+        vKFbVb[l] = static_cast<float>(mTimeStep * aGroup.mpFb[l] * aGroup.mpVb[l]);
+    }
+
+    ModalKernels::FreeResponseArgs vFreeResponseArgs;
+    vFreeResponseArgs.mpModesIn = aGroup.mpModesIn;
+    vFreeResponseArgs.mpDispl = aGroup.mpDispl;
+    vFreeResponseArgs.mpVel = aGroup.mpVel;
+    vFreeResponseArgs.mpVelDisplCoeffs = aGroup.mpVelDisplCoeffs;
+    vFreeResponseArgs.mpVelVelCoeffs = aGroup.mpVelVelCoeffs;
+    vFreeResponseArgs.mpFreeVel = aGroup.mpFreeVel;
+    vFreeResponseArgs.mModesNumber = aGroup.mModesNumber;
+
+    ModalKernels::BatchWriteBackArgs vWriteBackArgs;
+    vWriteBackArgs.mpModesIn = aGroup.mpModesIn;
+    vWriteBackArgs.mpModesInSchur = aGroup.mpModesInSchur;
+    vWriteBackArgs.mpModesOut = aGroup.mpModesOut;
+    vWriteBackArgs.mpFreeVel = aGroup.mpFreeVel;
+    vWriteBackArgs.mpBowTerms = vBowTerms;
+    vWriteBackArgs.mHalfTimeStep = static_cast<float>(0.5 * mTimeStep);
+    vWriteBackArgs.mpDispl = aGroup.mpDispl;
+    vWriteBackArgs.mpVel = aGroup.mpVel;
+    vWriteBackArgs.mModesNumber = aGroup.mModesNumber;
+
+    //Input projections of the first sample, the following ones are accumulated
+    //while writing the new states
+    vKernel.mpBatchInputProjection(aGroup.mpModesIn, aGroup.mpVel, aGroup.mModesNumber, vZeta1);
+
+    for (int n = 0; n < aNumSamples; ++n)
+    {
+        for (int l = 0; l < kLanes; ++l)
+        {
+            vEta[l] = vZeta1[l] - aGroup.mpVb[l];
+        }
+        mFriction.Evaluate(vKernel, vEta, vD, vLambda, kLanes);
+
+        vKernel.mpBatchFreeResponse(vFreeResponseArgs, vFreeProjection);
+
+        //Sherman-Morrison correction of every lane, an unbowed lane gets f = 0
+        for (int l = 0; l < kLanes; ++l)
+        {
+            float vZeta1Coeff = vHalfKFb[l] * (vLambda[l] - 2 * vD[l]) * vZeta1[l] + vKFbVb[l] * vD[l];
+            float vZ1Coeff = vHalfKFb[l] * vLambda[l];
+            float vVt1 = vZ1Coeff * aGroup.mpInSchurProjection[l];
+            float vVt2 = vFreeProjection[l] + vZeta1Coeff * aGroup.mpInSchurProjection[l];
+            vBowTerms[l] = vZeta1Coeff - vZ1Coeff * vVt2 / (1 + vVt1);
+        }
+
+        vKernel.mpBatchWriteBack(vWriteBackArgs, vZeta1, vOutputs);
+
+        for (int l = 0; l < kLanes; ++l)
+        {
+            if (aGroup.mStrings[l] >= 0)
+            {
+                apOutputs[aGroup.mStrings[l]][n] = aGroup.mpGain[l] * vOutputs[l];
+            }
+        }
+    }
+}
@@ -0,0 +1,135 @@
+/*
+  ==============================================================================
+
+    ModalStringBatch.h
+    Created: 17/10/2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <memory>
+#include <vector>
+#include "AlignedArena.h"
+#include "BowFriction.h"
+#include "ModalKernels.h"
+#include "ModalStringTables.h"
+
+/*
+Many independent modal stiff strings rendered side by side, one per SIMD lane.
+The strings are split in groups of ModalKernels::kBatchLanes, and the per-mode
+arrays of a group are interleaved so that each vector holds the same mode of
+consecutive strings. The friction, the Sherman-Morrison scalars and the
+reductions over the modes are then computed for every lane at once, with no
+horizontal sum, which fills the vector units even for strings with few modes.
+
+A group runs over the modes number of its largest string, the missing modes
+of the others and the unused lanes of the last group are zero padding. To
+waste as few lanes as possible the strings are grouped by modes number, the
+largest first.
+
+The physics is the one of ModalStiffStringProcessor without the active modes
+set, sleeping and node culling. An unbowed string runs the bowed update with
+zero bow force, which reduces to the free trapezoidal step. The parameters are
+not atomic: they are to be set by the thread calling ProcessBlock, between
+blocks.
+*/
+class ModalStringBatch
+{
+public:
+    //==========================================================================
+    //Every table set must have the same time step and no oversampling
+    explicit ModalStringBatch(const std::vector<std::shared_ptr<const ModalStringTables>>& aStrings);
+
+    ModalStringBatch(const ModalStringBatch&) = delete;
+    ModalStringBatch& operator=(const ModalStringBatch&) = delete;
+
+    //==========================================================================
+    //Parameters of string aString, in the order the strings were given
+    void SetInputPos(int aString, float aNewPos);
+    void SetReadPos(int aString, float aNewPos);
+    void SetGain(int aString, float aGain);
+    void SetBowPressure(int aString, float aPressure);
+    void SetBowSpeed(int aString, float aSpeed);
+
+    //Sets every oscillator of aString to zero
+    void ResetStringStates(int aString);
+
+    //Selects the instruction set of the batch kernels, returns false if not supported
+    bool SetKernelIsa(ModalKernels::Isa aIsa);
+
+    void SetFrictionAccuracy(BowFriction::Accuracy aAccuracy);
+
+    /*
+    Renders aNumSamples output values of every string, apOutputs[s] being the
+    output of string s.
+    */
+    void ProcessBlock(float* const* apOutputs, int aNumSamples);
+
+    int GetStringsNumber() const { return static_cast<int>(mStrings.size()); }
+    int GetGroupsNumber() const { return static_cast<int>(mGroups.size()); }
+
+    //Modes updated per sample over all the groups and lanes, padding included
+    int GetPaddedModesNumber() const;
+
+private:
+    //==========================================================================
+    static constexpr int kLanes = ModalKernels::kBatchLanes;
+
+    struct String
+    {
+        std::shared_ptr<const ModalStringTables> mpTables;
+        int mGroup{ 0 };
+        int mLane{ 0 };
+        float mExcitPos{ 0.f };
+        float mReadPos{ 0.f };
+    };
+
+    /*
+    Interleaved arrays of one group, each mModesNumber * kLanes floats long:
+        mpVelDisplCoeffs, mpVelVelCoeffs    constant coefficients
+        mpModesIn, mpModesInSchur           w and T^-1 * w at the bow
+        mpModesOut                          mode shapes at the pickup
+        mpDispl, mpVel                      states
+        mpFreeVel                           scratch of the free response
+    followed by per-lane values, kLanes floats each.
+    */
+    struct Group
+    {
+        int mModesNumber{ 0 };
+        AlignedArena mArena;
+
+        float* mpVelDisplCoeffs{ nullptr };
+        float* mpVelVelCoeffs{ nullptr };
+        float* mpModesIn{ nullptr };
+        float* mpModesInSchur{ nullptr };
+        float* mpModesOut{ nullptr };
+        float* mpDispl{ nullptr };
+        float* mpVel{ nullptr };
+        float* mpFreeVel{ nullptr };
+
+        //Per lane: string index or -1, bow and output parameters
+        int mStrings[kLanes];
+        float* mpFb{ nullptr };
+        float* mpVb{ nullptr };
+        float* mpGain{ nullptr };
+
+        //Per lane: w^T * T^-1 * w, updated with the input modes
+        float* mpInSchurProjection{ nullptr };
+    };
+
+    std::vector<String> mStrings;
+    std::vector<Group> mGroups;
+
+    double mTimeStep{ 0.0 };
+    float mA{ 100.f };
+    BowFriction::Evaluator mFriction{ 100.f };
+    const ModalKernels::Kernel* mpKernel{ nullptr };
+
+    //==========================================================================
+    void RecomputeInModes(const String& aString);
+    void RecomputeOutModes(const String& aString);
+
+    void RenderGroup(Group& aGroup, float* const* apOutputs, int aNumSamples);
+};
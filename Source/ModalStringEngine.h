@@ -0,0 +1,46 @@
+/*
+  ==============================================================================
+
+    ModalStringEngine.h
+    Created: 17/10/2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+/*
+Audio thread interface shared by the modal string engines: the dynamic
+ModalStiffStringProcessor, which handles any string and sample rate, and the
+StaticModalStiffString specialisations for the built-in presets.
+*/
+class ModalStringEngine
+{
+public:
+    virtual ~ModalStringEngine() = default;
+
+    //Play or pause the sound, the string is not reset
+    virtual void SetPlayState(bool aPlayState) = 0;
+
+    //Sets each oscillator to zero and pauses the sound
+    virtual void ResetStringStates() = 0;
+
+    //Input and output positions, in normalized percentage of string length
+    virtual void SetInputPos(float aNewPos) = 0;
+    virtual void SetReadPos(float aNewPos) = 0;
+
+    virtual void SetGain(float aGain) = 0;
+    virtual void SetBowPressure(float aPressure) = 0;
+    virtual void SetBowSpeed(float aSpeed) = 0;
+
+    //Modal energy below which an unbowed string goes to sleep, zero to disable
+    virtual void SetSleepEnergyFloor(float aEnergyFloor) = 0;
+
+    /*
+    Renders aNumSamples output values in apOutput, returning false if the block
+    is silent because the string is paused or sleeping.
+    */
+    virtual bool ProcessBlock(float* apOutput, int aNumSamples) = 0;
+
+    virtual int GetModesNumber() = 0;
+};
@@ -0,0 +1,173 @@
+#include "ModalStringTables.h"
+#include <cassert>
+#include <cmath>
+#include "ModeShapes.h"
+
+namespace
+{
+    constexpr float kPi = static_cast<float>(Global::kPi);
+}
+
+ModalStringTables::ModalStringTables(const Global::Strings::String& aString, double aTimeStep, int aOversamplingFactor)
+    : mString(aString)
+{
+    auto vPi = kPi;
+
+    //The Young modulus of the string is not read, mYoungMod stays zero and the
+    //stiffness terms vanish, as they always have in this engine
+    mRadius = mString.mRadius;
+    mDensity = mString.mDensity;
+    mTension = mString.mTension;
+    mLength = mString.mLength;
+
+    mArea = vPi * mRadius * mRadius;
+    mLinDensity = mDensity * mArea;
+    mInertia = (vPi * mRadius * mRadius * mRadius * mRadius) / 4;
+
+    mTimeStep = aTimeStep;
+    mOversamplingFactor = aOversamplingFactor;
+
+    RecomputeModesNumber();
+    AllocateArena();
+    RecomputeEigenFreqs();
+    RecomputeDampProfile();
+    PrecompileCoefficients();
+}
+
+std::shared_ptr<const ModalStringTables> ModalStringTables::Create(const Global::Strings::String& aString, double aSampleRate)
+{
+    return std::make_shared<const ModalStringTables>(aString, 1.0 / aSampleRate, 1);
+}
+
+void ModalStringTables::ComputeModes(float aPos, float* apModes, int aStride) const
+{
+    ModeShapes::Compute(aPos, mLength, apModes, mModesNumber, aStride);
+}
+
+//==========================================================================
+float ModalStringTables::ComputeEigenFreq(int aModeNumber) const
+{
+    auto vN = aModeNumber * kPi / mLength;
+    return sqrt((mTension / mLinDensity) * vN * vN + (mYoungMod * mInertia / mLinDensity) * vN * vN * vN * vN);
+}
+
+float ModalStringTables::ComputeDampCoeff(float aFreq) const
+{
+    auto vPi = kPi;
+    float vRhoAir = 1.225f;
+    float vMuAir = (float)1.619e-5;
+    auto vD0 = -2 * vRhoAir * vMuAir / (mDensity * mRadius * mRadius);
+    auto vD1 = -2 * vRhoAir * sqrt(2 * vMuAir) / (mDensity * mRadius);
+    auto vD2 = static_cast<float>(-1 / 18000);
+    auto vD3 = -0.003f * mYoungMod * mDensity * vPi * vPi * mRadius * mRadius * mRadius * mRadius * mRadius * mRadius / (4 * mTension * mTension);
+    return vD0 + vD1 * sqrt(aFreq) + vD2 * aFreq + vD3 * aFreq * aFreq * aFreq;
+}
+
+void ModalStringTables::RecomputeModesNumber()
+{
+    int vModesNumber = 1;
+    float vLimitFreq = 20e3 * 2 * kPi;
+    while (true)
+    {
+        auto vFreq = ComputeEigenFreq(vModesNumber);
+        if (vFreq > vLimitFreq)
+        {
+            --vModesNumber;
+            break;
+        }
+        ++vModesNumber;
+    }
+    mModesNumber = vModesNumber;
+}
+
+void ModalStringTables::AllocateArena()
+{
+    const int vArraysNumber = 9;
+    mModesStride = static_cast<int>(AlignedArena::RoundUp(mModesNumber));
+    mArena.Allocate(vArraysNumber * static_cast<std::size_t>(mModesStride));
+
+    float* vpArray = mArena.GetData();
+    for (float** vppArray : { &mpEigenFreqs, &mpDampCoeffs,
+        &mpInvSchurComp, &mpVelDisplCoeffs, &mpVelVelCoeffs,
+        &mpDecayM11, &mpDecayM12, &mpDecayM21, &mpDecayM22 })
+    {
+        *vppArray = vpArray;
+        vpArray += mModesStride;
+    }
+    assert(vpArray == mArena.GetData() + mArena.GetSize());
+}
+
+void ModalStringTables::RecomputeEigenFreqs()
+{
+    for (int i = 0; i < mModesNumber; ++i)
+    {
+        mpEigenFreqs[i] = ComputeEigenFreq(i + 1);
+    }
+}
+
+void ModalStringTables::RecomputeDampProfile()
+{
+    for (int i = 0; i < mModesNumber; ++i)
+    {
+        auto vFreq = mpEigenFreqs[i];
+        mpDampCoeffs[i] = - ComputeDampCoeff(vFreq);
+    }
+}
+
+void ModalStringTables::PrecompileCoefficients()
+{
+    /*
+    For each mode, with q displacement, p velocity, w the eigenfrequency and
+    s the damping coefficient, the trapezoidal scheme reads
+
+        A = [1, -k/2; k/2 w^2, 1]           B = [1, k/2; -k/2 w^2, 1 - k s]
+
+    Solving A x' = B x + bow terms by block elimination, the velocity update
+    is (B21 - A21 * B11) / S * q + (B22 - A21 * B12) / S * p, plus the bow
+    terms times 1 / S, with S = 1 - A21 * A12 the Schur complement. Since
+    A11 = B11 = 1 and A12 = -B12 = -k/2 for every mode, the displacement update
+    reduces to q' = q + k/2 * (p + p') and needs no per-mode coefficient.
+
+    Without bow the update of a sub-step is the linear map
+        [q'; p'] = [1 + k/2 * VelDispl, k/2 * (1 + VelVel); VelDispl, VelVel] * [q; p]
+    whose power over the oversampling factor gives the free decay of one
+    output sample.
+    */
+    const double vHalfTimeStep = 0.5 * mTimeStep;
+    for (int i = 0; i < mModesNumber; ++i)
+    {
+        double vOmegaSq = static_cast<double>(mpEigenFreqs[i]) * mpEigenFreqs[i];
+
+        double vA12 = -vHalfTimeStep;
+        double vA21 = vHalfTimeStep * vOmegaSq;
+        double vB12 = vHalfTimeStep;
+        double vB21 = -vHalfTimeStep * vOmegaSq;
+        double vB22 = 1 - mTimeStep * mpDampCoeffs[i];
+
+        double vInvSchurComp = 1 / (1 - vA21 * vA12);
+        double vVelDispl = (vB21 - vA21) * vInvSchurComp;
+        double vVelVel = (vB22 - vA21 * vB12) * vInvSchurComp;
+        mpInvSchurComp[i] = static_cast<float>(vInvSchurComp);
+        mpVelDisplCoeffs[i] = static_cast<float>(vVelDispl);
+        mpVelVelCoeffs[i] = static_cast<float>(vVelVel);
+
+        double vStep[2][2] = { { 1 + vHalfTimeStep * vVelDispl, vHalfTimeStep * (1 + vVelVel) },
+                               { vVelDispl, vVelVel } };
+        double vDecay[2][2] = { { 1, 0 }, { 0, 1 } };
+        for (int vOS = 0; vOS < mOversamplingFactor; ++vOS)
+        {
+            double vPrev[2][2] = { { vDecay[0][0], vDecay[0][1] }, { vDecay[1][0], vDecay[1][1] } };
+            for (int r = 0; r < 2; ++r)
+            {
+                for (int c = 0; c < 2; ++c)
+                {
+                    vDecay[r][c] = vStep[r][0] * vPrev[0][c] + vStep[r][1] * vPrev[1][c];
+                }
+            }
+        }
+        mpDecayM11[i] = static_cast<float>(vDecay[0][0]);
+        mpDecayM12[i] = static_cast<float>(vDecay[0][1]);
+        mpDecayM21[i] = static_cast<float>(vDecay[1][0]);
+        mpDecayM22[i] = static_cast<float>(vDecay[1][1]);
+    }
+}
@@ -0,0 +1,111 @@
+/*
+  ==============================================================================
+
+    ModalStringTables.h
+    Created: 17/10/2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <memory>
+#include "Global.h"
+#include "AlignedArena.h"
+
+/*
+Per-mode constant coefficients of a modal stiff string at one time step: the
+eigenfrequencies, the damping profile and the folded trapezoidal blocks read by
+the kernels. The tables depend only on the string and on the time step and are
+immutable once built, so every ModalStiffStringProcessor rendering the same
+string at the same rate can share one instance.
+*/
+class ModalStringTables
+{
+public:
+    //==========================================================================
+    ModalStringTables(const Global::Strings::String& aString, double aTimeStep, int aOversamplingFactor);
+
+    ModalStringTables(const ModalStringTables&) = delete;
+    ModalStringTables& operator=(const ModalStringTables&) = delete;
+
+    //Builds the tables of aString sampled at aSampleRate, without oversampling
+    static std::shared_ptr<const ModalStringTables> Create(const Global::Strings::String& aString, double aSampleRate);
+
+    //==========================================================================
+    const Global::Strings::String& GetString() const { return mString; }
+    double GetTimeStep() const { return mTimeStep; }
+    int GetOversamplingFactor() const { return mOversamplingFactor; }
+    float GetLength() const { return mLength; }
+
+    //Modes below 20kHz, and the length of each array rounded up to a cache line
+    int GetModesNumber() const { return mModesNumber; }
+    int GetModesStride() const { return mModesStride; }
+
+    //Shapes of every mode at aPos, in meters, in apModes[0], apModes[aStride], ..., see ModeShapes.h
+    void ComputeModes(float aPos, float* apModes, int aStride = 1) const;
+
+    //==========================================================================
+    const float* GetEigenFreqs() const { return mpEigenFreqs; }
+    const float* GetDampCoeffs() const { return mpDampCoeffs; }
+
+    //1 / Schur complement of the A block
+    const float* GetInvSchurComp() const { return mpInvSchurComp; }
+
+    //Free response of the velocity
+    const float* GetVelDisplCoeffs() const { return mpVelDisplCoeffs; }
+    const float* GetVelVelCoeffs() const { return mpVelVelCoeffs; }
+
+    //Free decay over one output sample, used while the bow is not in contact
+    const float* GetDecayM11() const { return mpDecayM11; }
+    const float* GetDecayM12() const { return mpDecayM12; }
+    const float* GetDecayM21() const { return mpDecayM21; }
+    const float* GetDecayM22() const { return mpDecayM22; }
+
+private:
+    //==========================================================================
+    Global::Strings::String mString;
+
+    //String params
+    float mRadius{ 0.f };
+    float mDensity{ 0.f };
+    float mTension{ 0.f };
+    float mArea{ 0.f };
+    float mLinDensity{ 0.f };
+    float mYoungMod{ 0.f };
+    float mInertia{ 0.f };
+    float mLength{ 0.f };
+
+    double mTimeStep{ 0.0 };
+    int mOversamplingFactor{ 0 };
+    int mModesNumber{ 0 };
+    int mModesStride{ 0 };
+
+    //The arrays, in this order, each mModesStride floats long with zero padding
+    AlignedArena mArena;
+
+    float* mpEigenFreqs{ nullptr };
+    float* mpDampCoeffs{ nullptr };
+    float* mpInvSchurComp{ nullptr };
+    float* mpVelDisplCoeffs{ nullptr };
+    float* mpVelVelCoeffs{ nullptr };
+    float* mpDecayM11{ nullptr };
+    float* mpDecayM12{ nullptr };
+    float* mpDecayM21{ nullptr };
+    float* mpDecayM22{ nullptr };
+
+    //==========================================================================
+    float ComputeEigenFreq(int aModeNumber) const;
+    float ComputeDampCoeff(float aFreq) const;
+
+    void RecomputeModesNumber();
+    void AllocateArena();
+    void RecomputeEigenFreqs();
+    void RecomputeDampProfile();
+
+    /*
+    Folds the per-mode trapezoidal blocks into the constant coefficients used by
+    the kernels, see ModalKernels.h.
+    */
+    void PrecompileCoefficients();
+};
@@ -0,0 +1,202 @@
+#include "ModalVoicePipeline.h"
+#include <algorithm>
+
+namespace
+{
+    //Blocks of events and samples the queues can hold
+    constexpr int kQueuedBlocks = 4;
+    constexpr int kEventsPerBlock = 256;
+}
+
+ModalVoicePipeline::ModalVoicePipeline(ModalVoicePool& aPool)
+    : mPool(aPool)
+{
+}
+
+ModalVoicePipeline::~ModalVoicePipeline()
+{
+    Stop();
+}
+
+void ModalVoicePipeline::Prepare(double aSampleRate, int aBlockSize)
+{
+    Stop();
+    mPool.Prepare(aSampleRate);
+
+    mLatencySamples = std::max(aBlockSize, 1);
+    mpEvents = std::make_unique<CommandQueue<Event>>(kQueuedBlocks * kEventsPerBlock);
+    mpSamples = std::make_unique<CommandQueue<float>>(kQueuedBlocks * mLatencySamples);
+    mRenderOutput.resize(mLatencySamples);
+    mReadOutput.resize(mLatencySamples);
+    mLateSamples = 0;
+
+    //The block of silence read while the first one renders
+    std::fill(mRenderOutput.begin(), mRenderOutput.end(), 0.f);
+    mpSamples->Push(mRenderOutput.data(), mRenderOutput.size());
+
+    mIsStopping.store(false);
+    mThread = std::thread(&ModalVoicePipeline::RunRenderThread, this);
+}
+
+void ModalVoicePipeline::Stop()
+{
+    if (!mThread.joinable())
+    {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> vLock(mMutex);
+        mIsStopping.store(true);
+    }
+    mWakeUp.notify_all();
+    mThread.join();
+}
+
+//==========================================================================
+void ModalVoicePipeline::NoteOn(int aNote, float aVelocity)
+{
+    Post({ Event::Type::NoteOn, aNote, aVelocity });
+}
+
+void ModalVoicePipeline::NoteOff(int aNote)
+{
+    Post({ Event::Type::NoteOff, aNote, 0.f });
+}
+
+void ModalVoicePipeline::AllNotesOff()
+{
+    Post({ Event::Type::AllNotesOff, 0, 0.f });
+}
+
+void ModalVoicePipeline::Render(int aNumSamples)
+{
+    if (aNumSamples > 0)
+    {
+        Post({ Event::Type::Render, aNumSamples, 0.f });
+    }
+}
+
+bool ModalVoicePipeline::Read(float* apOutput, int aNumSamples)
+{
+    if (!mpSamples)
+    {
+        return false;
+    }
+    //Samples of blocks already output as silence
+    if (mLateSamples > 0)
+    {
+        mLateSamples -= static_cast<long long>(mpSamples->Pop(nullptr, static_cast<std::size_t>(mLateSamples)));
+    }
+
+    bool vIsSounding = false;
+    for (int vStart = 0; vStart < aNumSamples; vStart += mLatencySamples)
+    {
+        int vNumSamples = std::min(mLatencySamples, aNumSamples - vStart);
+        int vReadSamples = static_cast<int>(mpSamples->Pop(mReadOutput.data(), vNumSamples));
+        for (int i = 0; i < vReadSamples; ++i)
+        {
+            if (mReadOutput[i] != 0.f)
+            {
+                vIsSounding = true;
+            }
+            apOutput[vStart + i] += mReadOutput[i];
+        }
+        if (vReadSamples < vNumSamples)
+        {
+            mLateSamples += vNumSamples - vReadSamples;
+            mUnderrunSamplesNumber += vNumSamples - vReadSamples;
+        }
+    }
+    return vIsSounding;
+}
+
+//==========================================================================
+void ModalVoicePipeline::Post(const Event& aEvent)
+{
+    if (!mpEvents || !mpEvents->Push(aEvent))
+    {
+        //Not prepared or too far behind, the event is lost
+        return;
+    }
+    //Orders the push before the sleepers load, see RunRenderThread
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (mSleepersNumber.load() > 0)
+    {
+        std::lock_guard<std::mutex> vLock(mMutex);
+        mWakeUp.notify_one();
+    }
+}
+
+void ModalVoicePipeline::RunRenderThread()
+{
+    Event vEvent{};
+    int vSpins = 0;
+    while (!mIsStopping.load(std::memory_order_relaxed))
+    {
+        if (!mpEvents->Pop(vEvent))
+        {
+            if (++vSpins < kSpinIterations)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            //The sleepers count is read by Post after pushing an event and the
+            //queue is checked by the wait after counting this thread, with a
+            //fence on both sides, so either Post wakes this thread or the wait
+            //sees the event
+            std::unique_lock<std::mutex> vLock(mMutex);
+            ++mSleepersNumber;
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            mWakeUp.wait(vLock, [this] { return mpEvents->GetSize() > 0 || mIsStopping.load(); });
+            --mSleepersNumber;
+            vSpins = 0;
+            continue;
+        }
+        vSpins = 0;
+
+        switch (vEvent.mType)
+        {
+        case Event::Type::Render:
+            if (!RenderSamples(vEvent.mValue))
+            {
+                return;
+            }
+            break;
+        case Event::Type::NoteOn:
+            mPool.NoteOn(vEvent.mValue, vEvent.mVelocity);
+            break;
+        case Event::Type::NoteOff:
+            mPool.NoteOff(vEvent.mValue);
+            break;
+        case Event::Type::AllNotesOff:
+            mPool.AllNotesOff();
+            break;
+        }
+    }
+}
+
+bool ModalVoicePipeline::RenderSamples(int aNumSamples)
+{
+    const int vCapacity = static_cast<int>(mRenderOutput.size());
+    for (int vStart = 0; vStart < aNumSamples; vStart += vCapacity)
+    {
+        int vNumSamples = std::min(vCapacity, aNumSamples - vStart);
+        mPool.ProcessBlock(mRenderOutput.data(), vNumSamples);
+
+        //The ring is full only if the audio thread has not read for blocks
+        std::size_t vPushed = 0;
+        while (vPushed < static_cast<std::size_t>(vNumSamples))
+        {
+            vPushed += mpSamples->Push(mRenderOutput.data() + vPushed, vNumSamples - vPushed);
+            if (mIsStopping.load(std::memory_order_relaxed))
+            {
+                return false;
+            }
+            if (vPushed < static_cast<std::size_t>(vNumSamples))
+            {
+                std::this_thread::yield();
+            }
+        }
+    }
+    return true;
+}
@@ -0,0 +1,126 @@
+/*
+  ==============================================================================
+
+    ModalVoicePipeline.h
+    Created: 17/10/2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "CommandQueue.h"
+#include "ModalVoicePool.h"
+
+/*
+Renders a ModalVoicePool one block ahead on a background thread, so that the
+cost of the voices does not count against the deadline of the audio callback.
+The audio thread only posts the notes and the number of samples to render,
+in the order of the block, and reads the samples rendered so far from a
+lock-free ring, which starts with one block of silence: the output is late
+by GetLatencySamples(), to be reported to the host.
+
+If the render thread is late the missing samples are silent and the samples
+rendered for them are dropped when they arrive, so the latency stays the same.
+The parameters are set on the pool as usual and applied by the render thread
+at the start of each block it renders. The pool may have workers of its own.
+
+The render thread spins for a while after each block and then sleeps: waking
+it takes a mutex, which only happens for the first block after an idle period.
+*/
+class ModalVoicePipeline
+{
+public:
+    //==========================================================================
+    explicit ModalVoicePipeline(ModalVoicePool& aPool);
+    ~ModalVoicePipeline();
+
+    ModalVoicePipeline(const ModalVoicePipeline&) = delete;
+    ModalVoicePipeline& operator=(const ModalVoicePipeline&) = delete;
+
+    /*
+    Prepares the pool and starts the render thread with a latency of
+    aBlockSize samples, to be called inside the PrepareToPlay. Not real time
+    safe.
+    */
+    void Prepare(double aSampleRate, int aBlockSize);
+
+    //Stops the render thread, e.g. before changing the pool
+    void Stop();
+
+    int GetLatencySamples() const { return mLatencySamples; }
+
+    //==========================================================================
+    //Audio thread, applied after the samples posted before them
+    void NoteOn(int aNote, float aVelocity);
+    void NoteOff(int aNote);
+    void AllNotesOff();
+
+    //Audio thread, asks for the next aNumSamples of the voices
+    void Render(int aNumSamples);
+
+    /*
+    Adds the next aNumSamples rendered samples to apOutput, returning false
+    if they are silent. Audio thread.
+    */
+    bool Read(float* apOutput, int aNumSamples);
+
+    //Samples rendered and not read yet, e.g. for tools waiting on the render thread
+    std::size_t GetReadySamplesNumber() const { return mpSamples ? mpSamples->GetSize() : 0; }
+
+    //Samples that were not rendered in time, may be read from any thread
+    long long GetUnderrunSamplesNumber() const { return mUnderrunSamplesNumber.load(); }
+
+private:
+    //==========================================================================
+    //Checks of the event queue before the render thread goes to sleep
+    static constexpr int kSpinIterations = 20000;
+
+    struct Event
+    {
+        enum class Type
+        {
+            Render,
+            NoteOn,
+            NoteOff,
+            AllNotesOff
+        };
+        Type mType;
+        int mValue;         //Samples to render or note
+        float mVelocity;
+    };
+
+    ModalVoicePool& mPool;
+    int mLatencySamples{ 0 };
+
+    std::unique_ptr<CommandQueue<Event>> mpEvents;
+    std::unique_ptr<CommandQueue<float>> mpSamples;
+
+    //Render thread
+    std::thread mThread;
+    std::vector<float> mRenderOutput;
+
+    //Audio thread, samples still to drop because they were rendered late
+    long long mLateSamples{ 0 };
+    std::vector<float> mReadOutput;
+
+    std::atomic<bool> mIsStopping{ false };
+    std::atomic<int> mSleepersNumber{ 0 };
+    std::mutex mMutex;
+    std::condition_variable mWakeUp;
+
+    std::atomic<long long> mUnderrunSamplesNumber{ 0 };
+
+    //==========================================================================
+    void Post(const Event& aEvent);
+    void RunRenderThread();
+
+    //Renders aNumSamples and pushes them in the ring, returns false if stopped
+    bool RenderSamples(int aNumSamples);
+};
@@ -0,0 +1,509 @@
+#include "ModalVoicePool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+
+namespace
+{
+    const Global::Strings::StringParams* const kOpenStrings[] = {
+        &Global::Strings::kCelloC2Params,
+        &Global::Strings::kCelloG2Params,
+        &Global::Strings::kCelloD3Params,
+        &Global::Strings::kCelloA3Params };
+
+    //Notes above the highest open string, i.e. the range of the fingerboard
+    constexpr int kFingerboardNotes = 36;
+
+    //A released voice sleeps once its energy has decayed by 60 dB since the bow left
+    constexpr float kReleaseEnergyRatio = 1e-6f;
+    constexpr float kMinSleepEnergyFloor = 1e-12f;
+
+    //Fundamental of the open string, the engine neglects the stiffness
+    double ComputeFundamental(const Global::Strings::StringParams& aParams)
+    {
+        double vLinDensity = aParams.mDensity * Global::kPi * aParams.mRadius * aParams.mRadius;
+        return std::sqrt(aParams.mTension / vLinDensity) / (2.0 * aParams.mLength);
+    }
+
+    double ComputeNoteFrequency(int aNote)
+    {
+        return 440.0 * std::pow(2.0, (aNote - 69) / 12.0);
+    }
+
+    int ComputeNearestNote(double aFrequency)
+    {
+        return static_cast<int>(std::lround(69.0 + 12.0 * std::log2(aFrequency / 440.0)));
+    }
+}
+
+ModalVoicePool::ModalVoicePool(int aVoicesNumber)
+{
+    SetVoicesNumber(aVoicesNumber);
+}
+
+void ModalVoicePool::Prepare(double aSampleRate)
+{
+    std::lock_guard<std::mutex> vLock(mNoteModesMutex);
+    if (aSampleRate == mSampleRate && !mNoteTables.empty())
+    {
+        return;
+    }
+    mSampleRate = aSampleRate;
+
+    mLowestNote = ComputeNearestNote(ComputeFundamental(*kOpenStrings[0]));
+    mHighestNote = ComputeNearestNote(ComputeFundamental(*kOpenStrings[3])) + kFingerboardNotes;
+
+    //Each note stops the highest open string not above it at the length of its pitch
+    mNoteTables.clear();
+    int vLargestNote = 0;
+    for (int vNote = mLowestNote; vNote <= mHighestNote; ++vNote)
+    {
+        double vFrequency = ComputeNoteFrequency(vNote);
+        const Global::Strings::StringParams* vpOpenString = kOpenStrings[0];
+        for (auto* vpCandidate : kOpenStrings)
+        {
+            if (ComputeNearestNote(ComputeFundamental(*vpCandidate)) <= vNote)
+            {
+                vpOpenString = vpCandidate;
+            }
+        }
+        Global::Strings::String vString(*vpOpenString);
+        vString.mLength = static_cast<float>(vString.mLength * ComputeFundamental(*vpOpenString) / vFrequency);
+        mNoteTables.push_back(ModalStringTables::Create(vString, aSampleRate));
+
+        if (mNoteTables.back()->GetModesNumber() > mNoteTables[vLargestNote]->GetModesNumber())
+        {
+            vLargestNote = static_cast<int>(mNoteTables.size()) - 1;
+        }
+    }
+
+    mpLargestTables = mNoteTables[vLargestNote];
+    for (auto& vVoice : mVoices)
+    {
+        vVoice.mpProcessor.reset();
+    }
+    InitializeVoices();
+
+    //Every buffer gets the tables, the first mode shapes are read at once
+    for (auto& vNoteModes : mNoteModesBuffers)
+    {
+        vNoteModes.assign(mNoteTables.size(), {});
+        for (std::size_t i = 0; i < mNoteTables.size(); ++i)
+        {
+            vNoteModes[i].mpTables = mNoteTables[i];
+        }
+    }
+    ComputeNoteModes();
+    mNoteModes.Acquire();
+    mStolenVoicesNumber.store(0);
+}
+
+void ModalVoicePool::SetVoicesNumber(int aVoicesNumber)
+{
+    std::lock_guard<std::mutex> vLock(mNoteModesMutex);
+    mVoices.resize(std::max(aVoicesNumber, 1));
+    mRenderedVoices.resize(mVoices.size());
+    InitializeVoices();
+}
+
+void ModalVoicePool::SetWorkersNumber(int aWorkersNumber, bool aPinThreads)
+{
+    mpWorkers.reset();
+    if (aWorkersNumber > 0)
+    {
+        mpWorkers = std::make_unique<RealtimeWorkerGroup>(aWorkersNumber, aPinThreads);
+    }
+    mIsFallback = false;
+    mDeadlineMisses = 0;
+    mIsParallel.store(mpWorkers != nullptr);
+}
+
+//==========================================================================
+void ModalVoicePool::NoteOn(int aNote, float aVelocity)
+{
+    if (aNote < mLowestNote || aNote > mHighestNote)
+    {
+        return;
+    }
+    Voice& vVoice = FindVoice(aNote);
+    if (vVoice.mNote != aNote || vVoice.mStage == Stage::Idle)
+    {
+        vVoice.mpProcessor->SetTables(GetNoteModes()[aNote - mLowestNote]);
+        vVoice.mpProcessor->SetGain(mApplied.mGain);
+        vVoice.mpProcessor->SetPlayState(true);
+        vVoice.mNote = aNote;
+        vVoice.mLevel = 0.f;
+    }
+    //A note played again on its ringing voice is bowed again from the current level
+    vVoice.mStage = Stage::Attack;
+    vVoice.mVelocity = std::clamp(aVelocity, 0.f, 1.f);
+    vVoice.mStartOrder = ++mNoteCounter;
+}
+
+void ModalVoicePool::NoteOff(int aNote)
+{
+    for (auto& vVoice : mVoices)
+    {
+        if (vVoice.mNote == aNote && (vVoice.mStage == Stage::Attack || vVoice.mStage == Stage::Hold))
+        {
+            vVoice.mStage = Stage::Release;
+        }
+    }
+}
+
+void ModalVoicePool::AllNotesOff()
+{
+    for (auto& vVoice : mVoices)
+    {
+        if (vVoice.mStage == Stage::Attack || vVoice.mStage == Stage::Hold)
+        {
+            vVoice.mStage = Stage::Release;
+        }
+    }
+}
+
+bool ModalVoicePool::PostNoteOn(int aNote, float aVelocity)
+{
+    return mCommands.Push({ Command::Type::NoteOn, aNote, aVelocity });
+}
+
+bool ModalVoicePool::PostNoteOff(int aNote)
+{
+    return mCommands.Push({ Command::Type::NoteOff, aNote, 0.f });
+}
+
+bool ModalVoicePool::PostAllNotesOff()
+{
+    return mCommands.Push({ Command::Type::AllNotesOff, 0, 0.f });
+}
+
+//==========================================================================
+void ModalVoicePool::SetInputPos(float aNewPos)
+{
+    std::lock_guard<std::mutex> vLock(mNoteModesMutex);
+    mInputPos = std::clamp(aNewPos, 0.f, 1.f);
+    ComputeNoteModes();
+}
+
+void ModalVoicePool::SetReadPos(float aNewPos)
+{
+    std::lock_guard<std::mutex> vLock(mNoteModesMutex);
+    mReadPos = std::clamp(aNewPos, 0.f, 1.f);
+    ComputeNoteModes();
+}
+
+void ModalVoicePool::SetGain(float aGain)
+{
+    mGain.store(aGain);
+}
+
+void ModalVoicePool::SetBowPressure(float aPressure)
+{
+    mBowPressure.store(aPressure);
+}
+
+void ModalVoicePool::SetBowSpeed(float aSpeed)
+{
+    mBowSpeed.store(aSpeed);
+}
+
+void ModalVoicePool::SetAttackTime(float aSeconds)
+{
+    mAttackTime.store(aSeconds);
+}
+
+void ModalVoicePool::SetReleaseTime(float aSeconds)
+{
+    mReleaseTime.store(aSeconds);
+}
+
+void ModalVoicePool::SetDeadline(float aBlockFraction)
+{
+    mDeadline.store(aBlockFraction);
+}
+
+//==========================================================================
+bool ModalVoicePool::ProcessBlock(float* apOutput, int aNumSamples)
+{
+    std::fill(apOutput, apOutput + aNumSamples, 0.f);
+    if (mNoteTables.empty())
+    {
+        return false;
+    }
+    ApplyCommands();
+    ApplyParameters();
+
+    const auto vStartTime = std::chrono::steady_clock::now();
+    const bool vIsParallel = mpWorkers && !mIsFallback;
+    bool vIsSounding = false;
+    int vActiveVoicesNumber = 0;
+    for (int vStart = 0; vStart < aNumSamples; vStart += kRenderBlock)
+    {
+        mRenderSamples = std::min(kRenderBlock, aNumSamples - vStart);
+        mRenderedVoicesNumber = 0;
+        for (auto& vVoice : mVoices)
+        {
+            if (vVoice.mStage != Stage::Idle)
+            {
+                mRenderedVoices[mRenderedVoicesNumber++] = &vVoice;
+            }
+        }
+        vActiveVoicesNumber = std::max(vActiveVoicesNumber, mRenderedVoicesNumber);
+
+        if (vIsParallel && mRenderedVoicesNumber > 1)
+        {
+            mpWorkers->ParallelFor(mRenderedVoicesNumber, &ModalVoicePool::RenderVoiceItem, this);
+        }
+        else
+        {
+            for (int i = 0; i < mRenderedVoicesNumber; ++i)
+            {
+                RenderVoice(*mRenderedVoices[i]);
+            }
+        }
+
+        //Summed in voice order, whatever thread rendered each voice
+        for (int i = 0; i < mRenderedVoicesNumber; ++i)
+        {
+            const Voice& vVoice = *mRenderedVoices[i];
+            if (vVoice.mIsSounding)
+            {
+                vIsSounding = true;
+                for (int n = 0; n < mRenderSamples; ++n)
+                {
+                    apOutput[vStart + n] += vVoice.mOutput[n];
+                }
+            }
+        }
+    }
+    mActiveVoicesNumber.store(vActiveVoicesNumber);
+
+    std::chrono::duration<double> vSeconds = std::chrono::steady_clock::now() - vStartTime;
+    UpdateDeadline(vSeconds.count(), aNumSamples, vIsParallel);
+    return vIsSounding;
+}
+
+//==========================================================================
+void ModalVoicePool::ApplyCommands()
+{
+    Command vCommand;
+    while (mCommands.Pop(vCommand))
+    {
+        switch (vCommand.mType)
+        {
+        case Command::Type::NoteOn:
+            NoteOn(vCommand.mNote, vCommand.mVelocity);
+            break;
+        case Command::Type::NoteOff:
+            NoteOff(vCommand.mNote);
+            break;
+        case Command::Type::AllNotesOff:
+            AllNotesOff();
+            break;
+        }
+    }
+}
+
+void ModalVoicePool::ApplyParameters()
+{
+    //New positions, the sounding voices copy the mode shapes of their note
+    //and the others take them at their next note on
+    if (mNoteModes.Acquire())
+    {
+        const auto& vNoteModes = GetNoteModes();
+        for (auto& vVoice : mVoices)
+        {
+            if (vVoice.mStage != Stage::Idle)
+            {
+                vVoice.mpProcessor->SetModes(vNoteModes[vVoice.mNote - mLowestNote]);
+            }
+        }
+    }
+    float vGain = mGain.load();
+    if (vGain != mApplied.mGain)
+    {
+        mApplied.mGain = vGain;
+        for (auto& vVoice : mVoices)
+        {
+            vVoice.mpProcessor->SetGain(vGain);
+        }
+    }
+    mApplied.mBowPressure = mBowPressure.load();
+    mApplied.mBowSpeed = mBowSpeed.load();
+    mApplied.mAttackTime = mAttackTime.load();
+    mApplied.mReleaseTime = mReleaseTime.load();
+}
+
+void ModalVoicePool::ComputeNoteModes()
+{
+    if (mNoteTables.empty())
+    {
+        return;
+    }
+
+    //Every voice culls the nodes alike, the first one computes the shapes
+    const ModalStiffStringProcessor& vProcessor = *mVoices.front().mpProcessor;
+    for (auto& vNoteModes : mNoteModesBuffers[mNoteModes.GetWriteIndex()])
+    {
+        vProcessor.ComputeStringModes(vNoteModes, mInputPos, mReadPos);
+    }
+    mNoteModes.Publish();
+}
+
+void ModalVoicePool::InitializeVoices()
+{
+    if (!mpLargestTables)
+    {
+        return;
+    }
+    //Built with the largest note, so that any other one fits without allocating
+    for (auto& vVoice : mVoices)
+    {
+        if (!vVoice.mpProcessor)
+        {
+            vVoice.mpProcessor = std::make_unique<ModalStiffStringProcessor>(mpLargestTables);
+            vVoice.mStage = Stage::Idle;
+            vVoice.mNote = -1;
+            vVoice.mLevel = 0.f;
+        }
+        vVoice.mOutput.resize(kRenderBlock);
+    }
+    mApplied = Parameters{ -1.f, 0.f, 0.f, 0.f, 0.f };
+    ApplyParameters();
+}
+
+void ModalVoicePool::RenderVoice(Voice& aVoice)
+{
+    //The envelope moves the bow at each control block
+    aVoice.mIsSounding = false;
+    for (int vStart = 0; vStart < mRenderSamples; vStart += kControlBlock)
+    {
+        int vNumSamples = std::min(kControlBlock, mRenderSamples - vStart);
+        UpdateEnvelope(aVoice, vNumSamples);
+        if (aVoice.mpProcessor->ProcessBlock(aVoice.mOutput.data() + vStart, vNumSamples))
+        {
+            aVoice.mIsSounding = true;
+        }
+        else if (aVoice.mStage == Stage::Release && aVoice.mLevel == 0.f)
+        {
+            //Released and asleep, the voice is free
+            aVoice.mStage = Stage::Idle;
+            aVoice.mNote = -1;
+            std::fill(aVoice.mOutput.begin() + vStart, aVoice.mOutput.begin() + mRenderSamples, 0.f);
+            break;
+        }
+    }
+}
+
+void ModalVoicePool::RenderVoiceItem(void* apPool, int aItem)
+{
+    auto* vpPool = static_cast<ModalVoicePool*>(apPool);
+    vpPool->RenderVoice(*vpPool->mRenderedVoices[aItem]);
+}
+
+void ModalVoicePool::UpdateDeadline(double aSeconds, int aNumSamples, bool aIsParallel)
+{
+    const double vLoad = aSeconds * mSampleRate / aNumSamples;
+    mRenderLoad.store(static_cast<float>(vLoad));
+    if (vLoad > mDeadline.load())
+    {
+        ++mDeadlineMissesNumber;
+        if (aIsParallel && ++mDeadlineMisses >= kMaxDeadlineMisses)
+        {
+            mIsFallback = true;
+            mFallbackBlocks = 0;
+        }
+    }
+    else
+    {
+        mDeadlineMisses = 0;
+    }
+
+    if (mIsFallback && ++mFallbackBlocks > kFallbackBlocks)
+    {
+        mIsFallback = false;
+        mDeadlineMisses = 0;
+    }
+    mIsParallel.store(mpWorkers && !mIsFallback);
+}
+
+ModalVoicePool::Voice& ModalVoicePool::FindVoice(int aNote)
+{
+    for (auto& vVoice : mVoices)
+    {
+        if (vVoice.mNote == aNote && vVoice.mStage != Stage::Idle)
+        {
+            return vVoice;
+        }
+    }
+    for (auto& vVoice : mVoices)
+    {
+        if (vVoice.mStage == Stage::Idle)
+        {
+            return vVoice;
+        }
+    }
+
+    //Released voices are stolen first, the quietest one, then the oldest held one
+    ++mStolenVoicesNumber;
+    Voice* vpQuietest = nullptr;
+    float vLowestEnergy = 0.f;
+    for (auto& vVoice : mVoices)
+    {
+        if (vVoice.mStage != Stage::Release)
+        {
+            continue;
+        }
+        float vEnergy = vVoice.mpProcessor->GetEnergy();
+        if (!vpQuietest || vEnergy < vLowestEnergy)
+        {
+            vpQuietest = &vVoice;
+            vLowestEnergy = vEnergy;
+        }
+    }
+    if (vpQuietest)
+    {
+        return *vpQuietest;
+    }
+    return *std::min_element(mVoices.begin(), mVoices.end(), [](const Voice& aLeft, const Voice& aRight)
+        {
+            return aLeft.mStartOrder < aRight.mStartOrder;
+        });
+}
+
+void ModalVoicePool::UpdateEnvelope(Voice& aVoice, int aNumSamples)
+{
+    switch (aVoice.mStage)
+    {
+    case Stage::Attack:
+    {
+        float vSamples = static_cast<float>(mApplied.mAttackTime * mSampleRate);
+        aVoice.mLevel = vSamples > 0.f ? std::min(aVoice.mLevel + aNumSamples / vSamples, 1.f) : 1.f;
+        if (aVoice.mLevel == 1.f)
+        {
+            aVoice.mStage = Stage::Hold;
+        }
+        break;
+    }
+    case Stage::Release:
+    {
+        if (aVoice.mLevel == 0.f)
+        {
+            break;
+        }
+        float vSamples = static_cast<float>(mApplied.mReleaseTime * mSampleRate);
+        aVoice.mLevel = vSamples > 0.f ? std::max(aVoice.mLevel - aNumSamples / vSamples, 0.f) : 0.f;
+        if (aVoice.mLevel == 0.f)
+        {
+            float vEnergy = aVoice.mpProcessor->GetEnergy();
+            aVoice.mpProcessor->SetSleepEnergyFloor(std::max(kReleaseEnergyRatio * vEnergy, kMinSleepEnergyFloor));
+        }
+        break;
+    }
+    case Stage::Idle:
+    case Stage::Hold:
+        break;
+    }
+    aVoice.mpProcessor->SetBowPressure(aVoice.mLevel * aVoice.mVelocity * mApplied.mBowPressure);
+    aVoice.mpProcessor->SetBowSpeed(aVoice.mLevel * mApplied.mBowSpeed);
+}
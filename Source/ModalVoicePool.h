@@ -0,0 +1,263 @@
+/*
+  ==============================================================================
+
+    ModalVoicePool.h
+    Created: 17/10/2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "CommandQueue.h"
+#include "ModalStiffStringProcessor.h"
+#include "ModalStringTables.h"
+#include "RealtimeWorkerGroup.h"
+#include "TripleBuffer.h"
+
+/*
+Polyphonic bowed strings played by notes. Each note is a cello string stopped
+at the length giving its pitch: the highest open string not above the note,
+or the lowest one. A note bows its voice with pressure and speed envelopes,
+rising over the attack time to the pressure times the velocity and to the
+bow speed, and falling to zero over the release time after the note off. The
+released string then rings until its energy has decayed by 60 dB, when it goes
+to sleep and frees its voice.
+
+Prepare builds the coefficient tables and the mode shapes of every note and
+the voices, sized for the note with the most modes, so that starting a note
+neither allocates nor computes anything: the voice switches to the tables and
+mode shapes of the note and clears its states. The mode shapes of every note
+are computed again by the thread setting the bow or pickup position, and
+published to the audio thread, which copies them to the sounding voices at the
+start of its next block. When no voice is free a note steals the released voice with
+the least energy, or else the oldest one, which is cut without fade.
+
+The note methods are to be called by the audio thread, e.g. for the MIDI
+events of the block. One other thread can post notes through the lock-free
+queue, they are applied at the start of the next block. The parameters can be
+set from any thread and are applied at the start of the next block too, the
+positions from any thread but the audio one.
+
+With workers, the voices of a block are shared out between the audio thread
+and the worker threads. Each voice renders in its own buffer and the buffers
+are summed in voice order, so the output does not depend on the threads. The
+time spent rendering is measured against a deadline, a fraction of the block
+duration: after kMaxDeadlineMisses blocks in a row over it, e.g. because the
+workers are not scheduled in time, the pool falls back to the audio thread
+alone, and tries the workers again after kFallbackBlocks blocks.
+*/
+class ModalVoicePool
+{
+public:
+    //==========================================================================
+    static constexpr int kDefaultVoicesNumber = 16;
+
+    //Envelopes are updated at most every kControlBlock samples
+    static constexpr int kControlBlock = 32;
+
+    //Voices are rendered in chunks of at most kRenderBlock samples
+    static constexpr int kRenderBlock = 256;
+
+    static constexpr int kMaxDeadlineMisses = 2;
+    static constexpr int kFallbackBlocks = 1024;
+
+    explicit ModalVoicePool(int aVoicesNumber = kDefaultVoicesNumber);
+
+    ModalVoicePool(const ModalVoicePool&) = delete;
+    ModalVoicePool& operator=(const ModalVoicePool&) = delete;
+
+    /*
+    Builds the note tables and the voices for aSampleRate, to be called inside
+    the PrepareToPlay. Nothing is rebuilt if the sample rate has not changed.
+    */
+    void Prepare(double aSampleRate);
+
+    /*
+    Changes the number of voices or of worker threads, zero rendering on the
+    audio thread only. Not to be called while the audio thread is processing.
+    */
+    void SetVoicesNumber(int aVoicesNumber);
+    void SetWorkersNumber(int aWorkersNumber, bool aPinThreads = true);
+
+    //==========================================================================
+    //Audio thread. Notes outside [GetLowestNote(), GetHighestNote()] are ignored
+    void NoteOn(int aNote, float aVelocity);
+    void NoteOff(int aNote);
+    void AllNotesOff();
+
+    //Any single other thread, returns false if the queue is full
+    bool PostNoteOn(int aNote, float aVelocity);
+    bool PostNoteOff(int aNote);
+    bool PostAllNotesOff();
+
+    //==========================================================================
+    /*
+    Bow and pickup positions of every voice, in normalized percentage of string
+    length. The calling thread computes the mode shapes of every note, so these
+    are not to be called by the audio thread.
+    */
+    void SetInputPos(float aNewPos);
+    void SetReadPos(float aNewPos);
+
+    void SetGain(float aGain);
+
+    //Bow pressure of a note at full velocity and bow speed of every note
+    void SetBowPressure(float aPressure);
+    void SetBowSpeed(float aSpeed);
+
+    void SetAttackTime(float aSeconds);
+    void SetReleaseTime(float aSeconds);
+
+    //Rendering time allowed to the voices, as a fraction of the block duration
+    void SetDeadline(float aBlockFraction);
+
+    //==========================================================================
+    /*
+    Writes the sum of the voices in apOutput, returning false if the block is
+    silent because no voice is sounding. Audio thread.
+    */
+    bool ProcessBlock(float* apOutput, int aNumSamples);
+
+    int GetVoicesNumber() const { return static_cast<int>(mVoices.size()); }
+    int GetWorkersNumber() const { return mpWorkers ? mpWorkers->GetWorkersNumber() : 0; }
+
+    //False if there are no workers or the pool has fallen back to the audio thread
+    bool IsParallel() const { return mIsParallel.load(); }
+
+    //Rendering time of the last block over its duration, may be read from any thread
+    float GetRenderLoad() const { return mRenderLoad.load(); }
+
+    //Blocks whose rendering missed the deadline, may be read from any thread
+    int GetDeadlineMissesNumber() const { return mDeadlineMissesNumber.load(); }
+
+    //Voices rendered in the last block, may be read from any thread
+    int GetActiveVoicesNumber() const { return mActiveVoicesNumber.load(); }
+
+    //Notes stolen since Prepare, may be read from any thread
+    int GetStolenVoicesNumber() const { return mStolenVoicesNumber.load(); }
+
+    int GetLowestNote() const { return mLowestNote; }
+    int GetHighestNote() const { return mHighestNote; }
+
+private:
+    //==========================================================================
+    enum class Stage
+    {
+        Idle,
+        Attack,
+        Hold,
+        Release
+    };
+
+    struct Voice
+    {
+        std::unique_ptr<ModalStiffStringProcessor> mpProcessor;
+        Stage mStage{ Stage::Idle };
+        int mNote{ -1 };
+        float mVelocity{ 0.f };
+        float mLevel{ 0.f };            //Envelope, from 0 to 1
+        std::uint64_t mStartOrder{ 0 }; //Order of the note ons, for the age
+
+        std::vector<float> mOutput;     //kRenderBlock samples
+        bool mIsSounding{ false };      //False if mOutput is silent
+    };
+
+    struct Command
+    {
+        enum class Type
+        {
+            NoteOn,
+            NoteOff,
+            AllNotesOff
+        };
+        Type mType;
+        int mNote;
+        float mVelocity;
+    };
+
+    //Parameters set from other threads and their values applied to the voices
+    struct Parameters
+    {
+        float mGain;
+        float mBowPressure;
+        float mBowSpeed;
+        float mAttackTime;
+        float mReleaseTime;
+    };
+
+    double mSampleRate{ 0.0 };
+    int mLowestNote{ 0 };
+    int mHighestNote{ -1 };
+
+    //Tables of each note from mLowestNote, shared by the voices
+    std::vector<std::shared_ptr<const ModalStringTables>> mNoteTables;
+
+    //Mode shapes of each note at the positions, written by the thread setting
+    //them and read by the audio thread. The mutex serializes the writers
+    std::vector<ModalStiffStringProcessor::StringModes> mNoteModesBuffers[3];
+    TripleBuffer mNoteModes;
+    std::mutex mNoteModesMutex;
+    std::shared_ptr<const ModalStringTables> mpLargestTables;
+    std::vector<Voice> mVoices;
+    std::uint64_t mNoteCounter{ 0 };
+
+    //Workers and the voices rendered in the current chunk
+    std::unique_ptr<RealtimeWorkerGroup> mpWorkers;
+    std::vector<Voice*> mRenderedVoices;
+    int mRenderedVoicesNumber{ 0 };
+    int mRenderSamples{ 0 };
+    int mDeadlineMisses{ 0 };
+    int mFallbackBlocks{ 0 };
+    bool mIsFallback{ false };
+
+    CommandQueue<Command> mCommands{ 1024 };
+
+    //Positions of the mode shapes, guarded by mNoteModesMutex
+    float mInputPos{ 0.733f };
+    float mReadPos{ 0.53f };
+    std::atomic<float> mGain{ 1000.f };
+    std::atomic<float> mBowPressure{ 10.f };
+    std::atomic<float> mBowSpeed{ 0.2f };
+    std::atomic<float> mAttackTime{ 0.05f };
+    std::atomic<float> mReleaseTime{ 0.1f };
+    std::atomic<float> mDeadline{ 0.5f };
+    Parameters mApplied{};
+
+    std::atomic<int> mActiveVoicesNumber{ 0 };
+    std::atomic<int> mStolenVoicesNumber{ 0 };
+    std::atomic<bool> mIsParallel{ false };
+    std::atomic<float> mRenderLoad{ 0.f };
+    std::atomic<int> mDeadlineMissesNumber{ 0 };
+
+    //==========================================================================
+    void ApplyCommands();
+    void ApplyParameters();
+
+    //Computes and publishes the mode shapes of every note, with mNoteModesMutex held
+    void ComputeNoteModes();
+
+    //Mode shapes of each note read by the audio thread
+    const std::vector<ModalStiffStringProcessor::StringModes>& GetNoteModes() const { return mNoteModesBuffers[mNoteModes.GetReadIndex()]; }
+
+    //Creates the processors and buffers that are missing, once prepared
+    void InitializeVoices();
+
+    //Renders mRenderSamples of aVoice in its buffer, from any thread
+    void RenderVoice(Voice& aVoice);
+    static void RenderVoiceItem(void* apPool, int aItem);
+
+    //Updates the deadline state with the rendering time of a block
+    void UpdateDeadline(double aSeconds, int aNumSamples, bool aIsParallel);
+
+    //Returns the voice for a new note, stealing one if none is free
+    Voice& FindVoice(int aNote);
+
+    //Advances the envelope of aVoice by aNumSamples and sets its bow
+    void UpdateEnvelope(Voice& aVoice, int aNumSamples);
+};
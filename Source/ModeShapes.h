@@ -0,0 +1,110 @@
+/*
+  ==============================================================================
+
+    ModeShapes.h
+    Created: 17/10/2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include "Global.h"
+
+/*
+Mode shapes of a string fixed at both ends, sqrt(2 / L) * sin(n * pi * x / L)
+for the modes n from 1, evaluated for every mode at once with the Chebyshev
+recurrence
+
+    sin((n + 1) * theta) = 2 * cos(theta) * sin(n * theta) - sin((n - 1) * theta)
+
+i.e. one multiply-add per mode instead of one sine. The recurrence runs in
+double and restarts from exact sines every kRestartModes modes, which bounds
+its drift far below the float precision of the shapes.
+*/
+namespace ModeShapes
+{
+    constexpr int kRestartModes = 64;
+
+    /*
+    Writes aScale * sin(n * aTheta + aPhase) for n from 1 to aModesNumber in
+    apValues[0], apValues[aStride], ... The cosines are the sines of phase pi/2.
+    */
+    inline void ComputeHarmonics(double aTheta, double aPhase, double aScale, float* apValues, int aModesNumber, int aStride = 1)
+    {
+        const double vTwoCos = 2 * std::cos(aTheta);
+        for (int vStart = 0; vStart < aModesNumber; vStart += kRestartModes)
+        {
+            const int vEnd = std::min(vStart + kRestartModes, aModesNumber);
+
+            //Harmonics vStart and vStart + 1
+            double vPrev = std::sin(vStart * aTheta + aPhase);
+            double vCurr = std::sin((vStart + 1) * aTheta + aPhase);
+            for (int n = vStart; n < vEnd; ++n)
+            {
+                apValues[n * aStride] = static_cast<float>(aScale * vCurr);
+                double vNext = vTwoCos * vCurr - vPrev;
+                vPrev = vCurr;
+                vCurr = vNext;
+            }
+        }
+    }
+
+    /*
+    Writes aScale * sin(n * aTheta), aScale * cos(n * aTheta), cos(n * aStep)
+    and sin(n * aStep) for n from 1 to aModesNumber, i.e. mode shapes with
+    their quadrature and the rotation of each mode by the angle aStep, see
+    ModalKernels::ModesRotationArgs. The four recurrences run interleaved.
+    */
+    inline void ComputeRotatingHarmonics(double aTheta, double aScale, double aStep, float* apSin, float* apCos,
+        float* apStepCos, float* apStepSin, int aModesNumber)
+    {
+        const double vTwoCos = 2 * std::cos(aTheta);
+        const double vStepTwoCos = 2 * std::cos(aStep);
+        for (int vStart = 0; vStart < aModesNumber; vStart += kRestartModes)
+        {
+            const int vEnd = std::min(vStart + kRestartModes, aModesNumber);
+
+            //Harmonics vStart and vStart + 1 of each recurrence
+            double vSinPrev = std::sin(vStart * aTheta);
+            double vSin = std::sin((vStart + 1) * aTheta);
+            double vCosPrev = std::cos(vStart * aTheta);
+            double vCos = std::cos((vStart + 1) * aTheta);
+            double vStepCosPrev = std::cos(vStart * aStep);
+            double vStepCos = std::cos((vStart + 1) * aStep);
+            double vStepSinPrev = std::sin(vStart * aStep);
+            double vStepSin = std::sin((vStart + 1) * aStep);
+            for (int n = vStart; n < vEnd; ++n)
+            {
+                apSin[n] = static_cast<float>(aScale * vSin);
+                apCos[n] = static_cast<float>(aScale * vCos);
+                apStepCos[n] = static_cast<float>(vStepCos);
+                apStepSin[n] = static_cast<float>(vStepSin);
+
+                double vNextSin = vTwoCos * vSin - vSinPrev;
+                double vNextCos = vTwoCos * vCos - vCosPrev;
+                double vNextStepCos = vStepTwoCos * vStepCos - vStepCosPrev;
+                double vNextStepSin = vStepTwoCos * vStepSin - vStepSinPrev;
+                vSinPrev = vSin;
+                vSin = vNextSin;
+                vCosPrev = vCos;
+                vCos = vNextCos;
+                vStepCosPrev = vStepCos;
+                vStepCos = vNextStepCos;
+                vStepSinPrev = vStepSin;
+                vStepSin = vNextStepSin;
+            }
+        }
+    }
+
+    /*
+    Writes the shapes of the modes 1 to aModesNumber at aPos, in meters, in
+    apModes[0], apModes[aStride], ... for a string of length aLength.
+    */
+    inline void Compute(float aPos, float aLength, float* apModes, int aModesNumber, int aStride = 1)
+    {
+        ComputeHarmonics(Global::kPi * aPos / aLength, 0.0, std::sqrt(2.0 / aLength), apModes, aModesNumber, aStride);
+    }
+}
@@ -17,11 +17,11 @@ FastBowedStringAudioProcessorEditor::FastBowedStringAudioProcessorEditor (FastBo
     // Make sure that before the constructor has finished, you've set the
     // editor's size to whatever you need it to be.
     
-    // Get the bowed1dWave pointer to put it in the application (see resized())
-    bowed1DWaveFirstOrder = p.getBowed1DWaveFirstOrderPtr();
+    // Create the view of the bowed1dWave to put it in the application (see resized())
+    bowed1DWaveFirstOrderView = std::make_unique<Bowed1DWaveFirstOrderView> (p.getBowed1DWaveFirstOrderPtr());
     
-    // Add the bowed1DWave to the application and make it visible (a JUCE must-have)
-    addAndMakeVisible (bowed1DWaveFirstOrder.get());
+    // Add the bowed1DWave view to the application and make it visible (a JUCE must-have)
+    addAndMakeVisible (bowed1DWaveFirstOrderView.get());
     
     
     dbgLabel = std::make_unique<Label>();
@@ -57,8 +57,8 @@ void FastBowedStringAudioProcessorEditor::resized()
 {
 #if TIME_DOMAIN_STRING
     // Position the bowed1DWave in the application (fully encompassing the application bounds)
-    if (bowed1DWaveFirstOrder != nullptr)
-        bowed1DWaveFirstOrder->setBounds(getLocalBounds());
+    if (bowed1DWaveFirstOrderView != nullptr)
+        bowed1DWaveFirstOrderView->setBounds(getLocalBounds());
     
     dbgLabel->setBounds (0, getHeight() - 50, getWidth(), 50);
 #else
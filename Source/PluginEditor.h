@@ -11,7 +11,7 @@
 #include <JuceHeader.h>
 #include "Global.h"
 #include "PluginProcessor.h"
-#include "Bowed1DWaveFirstOrder.h"
+#include "Bowed1DWaveFirstOrderView.h"
 #include "ModalStiffStringView.h"
 //==============================================================================
 /**
@@ -32,7 +32,7 @@ private:
     // access the processor object that created it.
     FastBowedStringAudioProcessor& audioProcessor;
     
-    std::shared_ptr<Bowed1DWaveFirstOrder> bowed1DWaveFirstOrder;
+    std::unique_ptr<Bowed1DWaveFirstOrderView> bowed1DWaveFirstOrderView;
     std::unique_ptr<Label> dbgLabel;
 
     std::unique_ptr<ModalStiffStringView> mpModalStiffString;
@@ -106,6 +106,39 @@ void FastBowedStringAudioProcessor::prepareToPlay (double sampleRate, int sample
     {
         mpModalStiffStringProcessor->SetTimeStep(1.0 / sampleRate);
     }   
+    //One pickup per output channel, all placed from the read position of the
+    //editor, e.g. the right channel at its mirror in stereo
+    const int vPickupsNumber = std::clamp(getTotalNumOutputChannels(), 1, ModalStiffStringProcessor::kMaxPickups);
+    if (mpModalStiffStringProcessor->GetPickupsNumber() != vPickupsNumber)
+    {
+        mpModalStiffStringProcessor->SetPickupsNumber(vPickupsNumber);
+        mpModalStiffStringProcessor->SetPickupsReadPos(mpModalStiffStringProcessor->GetReadPos());
+    }
+#if PIPELINED_VOICES
+    //The pool is not to be changed while the render thread uses it
+    mVoicePipeline.Stop();
+#endif
+#if PARALLEL_VOICES
+    //The polyphony grows with the cores, the audio thread renders voices too
+    if (mVoicePool.GetWorkersNumber() == 0 && RealtimeWorkerGroup::GetDefaultWorkersNumber() > 0)
+    {
+        int vWorkersNumber = RealtimeWorkerGroup::GetDefaultWorkersNumber();
+        mVoicePool.SetWorkersNumber(vWorkersNumber);
+        mVoicePool.SetVoicesNumber(ModalVoicePool::kDefaultVoicesNumber * (1 + vWorkersNumber));
+    }
+#endif
+#if PIPELINED_VOICES
+    mVoicePipeline.Prepare(sampleRate, samplesPerBlock);
+    setLatencySamples(mVoicePipeline.GetLatencySamples());
+
+    //The string is delayed like the voices, so the latency applies to the whole output
+    mStringDelay.assign(getTotalNumOutputChannels(), std::vector<float>(mVoicePipeline.GetLatencySamples(), 0.f));
+    mStringDelayPos = 0;
+    mStringSilentSamples = mVoicePipeline.GetLatencySamples();
+#else
+    mVoicePool.Prepare(sampleRate);
+#endif
+    mVoicesOutput.resize(std::max(samplesPerBlock, 1));
 #endif
 
     // save samplerate and block size
@@ -169,9 +202,9 @@ void FastBowedStringAudioProcessor::processBlock (juce::AudioBuffer<float>& buff
     //for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
     //    buffer.clear (i, 0, buffer.getNumSamples());
 
-    float vOutput = 0.0;
-    
 #if TIME_DOMAIN_STRING
+    float vOutput = 0.0;
+
     // Get pointers to output locations
     float* const channelData1 = buffer.getWritePointer(0);
     float* const channelData2 = totalNumOutputChannels > 1 ? buffer.getWritePointer(1) : nullptr;
@@ -234,17 +267,52 @@ void FastBowedStringAudioProcessor::processBlock (juce::AudioBuffer<float>& buff
     // Get the current time
     //double vNow = Time::getMillisecondCounterHiRes();
 
-    for (int i = 0; i < buffer.getNumSamples(); ++i)
+    //The string is read by one pickup per channel in a single pass
+    bool vIsSounding = mpModalStiffStringProcessor->ProcessBlock(buffer.getArrayOfWritePointers(), totalNumOutputChannels,
+        buffer.getNumSamples());
+#if PIPELINED_VOICES
+    vIsSounding = DelayString(buffer, vIsSounding);
+#endif
+
+    //The voices are rendered up to each MIDI event, which is then applied, and
+    //added to every channel
+    int vStart = 0;
+    for (const auto vMetadata : midiMessages)
     {
-        mpModalStiffStringProcessor->ComputeState();
-        //vOutput = mpLPFilter->update(mpModalStiffStringProcessor->ReadOutput());
-        vOutput = mpModalStiffStringProcessor->ReadOutput();
-        //DBG(Global::limitOutput(vOutput));
-        //jassert(vOutput <= 1 && vOutput >= -1);
-        for (int channel = 0; channel < totalNumOutputChannels; ++channel)
+        int vEnd = std::clamp(vMetadata.samplePosition, vStart, buffer.getNumSamples());
+        vIsSounding |= RenderVoices(buffer, vStart, vEnd);
+        HandleMidiMessage(vMetadata.getMessage());
+        vStart = vEnd;
+    }
+    vIsSounding |= RenderVoices(buffer, vStart, buffer.getNumSamples());
+#if PIPELINED_VOICES
+    //The samples asked for a block earlier
+    const int vCapacity = static_cast<int>(mVoicesOutput.size());
+    for (int vReadStart = 0; vReadStart < buffer.getNumSamples(); vReadStart += vCapacity)
+    {
+        int vNumSamples = std::min(vCapacity, buffer.getNumSamples() - vReadStart);
+        std::fill(mVoicesOutput.begin(), mVoicesOutput.begin() + vNumSamples, 0.f);
+        if (mVoicePipeline.Read(mVoicesOutput.data(), vNumSamples))
         {
-            auto vpBuffer = buffer.getWritePointer(channel);
-            vpBuffer[i] = Global::limitOutput(vOutput);
+            vIsSounding = true;
+            AddVoices(buffer, vReadStart, vNumSamples);
+        }
+    }
+#endif
+
+    if (!vIsSounding)
+    {
+        //Paused or sleeping strings, nothing to limit
+        buffer.clear();
+        return;
+    }
+    for (int channel = 0; channel < totalNumOutputChannels; ++channel)
+    {
+        auto vpChannel = buffer.getWritePointer(channel);
+        for (int i = 0; i < buffer.getNumSamples(); ++i)
+        {
+            //jassert(vpChannel[i] <= 1 && vpChannel[i] >= -1);
+            vpChannel[i] = Global::limitOutput(vpChannel[i]);
         }
     }
 
@@ -287,6 +355,85 @@ std::shared_ptr<ModalStiffStringProcessor> FastBowedStringAudioProcessor::GetMod
     return mpModalStiffStringProcessor;
 }
 
+bool FastBowedStringAudioProcessor::RenderVoices(juce::AudioBuffer<float>& aBuffer, int aStart, int aEnd)
+{
+#if PIPELINED_VOICES
+    //Rendered by the pipeline and read at the end of the block
+    juce::ignoreUnused(aBuffer);
+    mVoicePipeline.Render(aEnd - aStart);
+    return false;
+#else
+    bool vIsSounding = false;
+    const int vCapacity = static_cast<int>(mVoicesOutput.size());
+    for (int vStart = aStart; vStart < aEnd; vStart += vCapacity)
+    {
+        int vNumSamples = std::min(vCapacity, aEnd - vStart);
+        if (mVoicePool.ProcessBlock(mVoicesOutput.data(), vNumSamples))
+        {
+            vIsSounding = true;
+            AddVoices(aBuffer, vStart, vNumSamples);
+        }
+    }
+    return vIsSounding;
+#endif
+}
+
+bool FastBowedStringAudioProcessor::DelayString(juce::AudioBuffer<float>& aBuffer, bool aIsSounding)
+{
+    const int vNumSamples = aBuffer.getNumSamples();
+    const int vDelay = mStringDelay.empty() ? 0 : static_cast<int>(mStringDelay.front().size());
+    if (vDelay == 0)
+    {
+        return aIsSounding;
+    }
+    const int vChannelsNumber = std::min(aBuffer.getNumChannels(), static_cast<int>(mStringDelay.size()));
+    for (int vChannel = 0; vChannel < vChannelsNumber; ++vChannel)
+    {
+        float* vpChannel = aBuffer.getWritePointer(vChannel);
+        float* vpDelay = mStringDelay[vChannel].data();
+        int vPos = mStringDelayPos;
+        for (int i = 0; i < vNumSamples; ++i)
+        {
+            std::swap(vpChannel[i], vpDelay[vPos]);
+            vPos = vPos + 1 < vDelay ? vPos + 1 : 0;
+        }
+    }
+    mStringDelayPos = static_cast<int>((mStringDelayPos + static_cast<long long>(vNumSamples)) % vDelay);
+
+    //The delayed block sounds until the last sounding sample has left the delay
+    mStringSilentSamples = aIsSounding ? 0 : std::min(mStringSilentSamples + vNumSamples, vDelay + vNumSamples);
+    return mStringSilentSamples < vDelay + vNumSamples;
+}
+
+void FastBowedStringAudioProcessor::AddVoices(juce::AudioBuffer<float>& aBuffer, int aStart, int aNumSamples)
+{
+    for (int vChannel = 0; vChannel < getTotalNumOutputChannels(); ++vChannel)
+    {
+        aBuffer.addFrom(vChannel, aStart, mVoicesOutput.data(), aNumSamples);
+    }
+}
+
+void FastBowedStringAudioProcessor::HandleMidiMessage(const juce::MidiMessage& aMessage)
+{
+#if PIPELINED_VOICES
+    auto& vVoices = mVoicePipeline;
+#else
+    auto& vVoices = mVoicePool;
+#endif
+    if (aMessage.isNoteOn())
+    {
+        vVoices.NoteOn(aMessage.getNoteNumber(), aMessage.getFloatVelocity());
+    }
+    else if (aMessage.isNoteOff())
+    {
+        vVoices.NoteOff(aMessage.getNoteNumber());
+    }
+    else if (aMessage.isAllNotesOff() || aMessage.isAllSoundOff())
+    {
+        vVoices.AllNotesOff();
+    }
+}
+
 
 //==============================================================================
 // This creates new instances of the plugin..
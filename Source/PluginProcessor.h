@@ -12,6 +12,8 @@
 #include "Global.h"
 #include "Bowed1DWaveFirstOrder.h"
 #include "ModalStiffStringProcessor.h"
+#include "ModalVoicePipeline.h"
+#include "ModalVoicePool.h"
 #include "PA_LowPass2.h"
 
 //==============================================================================
@@ -61,6 +63,9 @@ public:
     std::shared_ptr<Bowed1DWaveFirstOrder> getBowed1DWaveFirstOrderPtr() { return bowed1DWaveFirstOrder; };
     std::shared_ptr<ModalStiffStringProcessor> GetModalStringProcessor();
 
+    //Strings played by the MIDI notes, next to the one driven by the editor
+    ModalVoicePool& GetVoicePool() { return mVoicePool; }
+
     // Function for the editor to retrieve information about the state of the plugin (current sample number, or "diffsum")
     String getDebugString();
 private:
@@ -72,6 +77,31 @@ private:
 
     std::shared_ptr<ModalStiffStringProcessor> mpModalStiffStringProcessor;
 
+    ModalVoicePool mVoicePool;
+
+    //Renders the voices one block ahead with PIPELINED_VOICES
+    ModalVoicePipeline mVoicePipeline{ mVoicePool };
+
+    //Output of the voices, added to every pickup of the editor string
+    std::vector<float> mVoicesOutput;
+
+    //Renders the voices from aStart to aEnd and adds them to every channel of
+    //aBuffer, returning true if they are sounding
+    bool RenderVoices(juce::AudioBuffer<float>& aBuffer, int aStart, int aEnd);
+
+    //String output delayed by the latency of the pipeline, one delay line per channel
+    std::vector<std::vector<float>> mStringDelay;
+    int mStringDelayPos{ 0 };
+    int mStringSilentSamples{ 0 };
+
+    //Delays the string in aBuffer by the latency of the pipeline, returning
+    //true if the delayed string is sounding
+    bool DelayString(juce::AudioBuffer<float>& aBuffer, bool aIsSounding);
+
+    //Adds the first aNumSamples of mVoicesOutput to every channel of aBuffer from aStart
+    void AddVoices(juce::AudioBuffer<float>& aBuffer, int aStart, int aNumSamples);
+    void HandleMidiMessage(const juce::MidiMessage& aMessage);
+
     std::unique_ptr<PA_LowPass2> mpLPFilter;
     
     // Current sample (debugging purposes only)
@@ -0,0 +1,216 @@
+#include "RealtimeWorkerGroup.h"
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#include <immintrin.h>
+#define FASTBOWEDSTRING_X86 1
+#endif
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace
+{
+    //Lets the other hyperthread of the core run while spinning
+    inline void CpuRelax()
+    {
+#if FASTBOWEDSTRING_X86
+        _mm_pause();
+#else
+        std::this_thread::yield();
+#endif
+    }
+
+    std::uint32_t GetGeneration(std::uint64_t aClaim)
+    {
+        return static_cast<std::uint32_t>(aClaim >> 32);
+    }
+
+    std::uint32_t GetItem(std::uint64_t aClaim)
+    {
+        return static_cast<std::uint32_t>(aClaim);
+    }
+
+    //Item of a job whose items can no longer be claimed
+    constexpr std::uint32_t kClosedClaim = 0xFFFFFFFFu;
+}
+
+RealtimeWorkerGroup::RealtimeWorkerGroup(int aWorkersNumber, bool aPinThreads)
+{
+    for (int i = 0; i < aWorkersNumber; ++i)
+    {
+        mThreads.emplace_back(&RealtimeWorkerGroup::RunWorker, this, i, aPinThreads);
+    }
+}
+
+RealtimeWorkerGroup::~RealtimeWorkerGroup()
+{
+    {
+        std::lock_guard<std::mutex> vLock(mMutex);
+        mIsStopping.store(true);
+    }
+    mWakeUp.notify_all();
+    for (auto& vThread : mThreads)
+    {
+        vThread.join();
+    }
+}
+
+int RealtimeWorkerGroup::GetDefaultWorkersNumber()
+{
+    return std::max(static_cast<int>(std::thread::hardware_concurrency()) - 1, 0);
+}
+
+int RealtimeWorkerGroup::ParallelFor(int aItemsNumber, Function aFunction, void* apContext)
+{
+    if (aItemsNumber <= 0)
+    {
+        return 0;
+    }
+    if (mThreads.empty())
+    {
+        for (int i = 0; i < aItemsNumber; ++i)
+        {
+            aFunction(apContext, i);
+        }
+        return 0;
+    }
+
+    //The previous job is over, its claim is closed before the fields are
+    //written so that a late worker reading them cannot claim an item of it
+    const std::uint32_t vGeneration = GetGeneration(mClaim.load()) + 1;
+    mClaim.store((static_cast<std::uint64_t>(vGeneration - 1) << 32) | kClosedClaim);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    //The job is published by the new generation
+    mFunction.store(aFunction, std::memory_order_relaxed);
+    mpContext.store(apContext, std::memory_order_relaxed);
+    mItemsNumber.store(aItemsNumber, std::memory_order_relaxed);
+    mDoneItems.store(0, std::memory_order_relaxed);
+    mWorkerItems.store(0, std::memory_order_relaxed);
+#if FASTBOWEDSTRING_X86
+    mFloatMode.store(_mm_getcsr(), std::memory_order_relaxed);
+#endif
+    mClaim.store(static_cast<std::uint64_t>(vGeneration) << 32);
+
+    if (mSleepersNumber.load() > 0)
+    {
+        std::lock_guard<std::mutex> vLock(mMutex);
+        mWakeUp.notify_all();
+    }
+
+    RunItems(vGeneration, false);
+
+    //Only the items started by the workers are left
+    while (mDoneItems.load(std::memory_order_acquire) < aItemsNumber)
+    {
+        CpuRelax();
+    }
+    return mWorkerItems.load(std::memory_order_relaxed);
+}
+
+void RealtimeWorkerGroup::RunWorker(int aIndex, bool aPinThread)
+{
+#if defined(__linux__)
+    //The calling thread is left the first core
+    unsigned vCores = std::max(std::thread::hardware_concurrency(), 1u);
+    if (aPinThread)
+    {
+        cpu_set_t vCpuSet;
+        CPU_ZERO(&vCpuSet);
+        CPU_SET((aIndex + 1) % vCores, &vCpuSet);
+        pthread_setaffinity_np(pthread_self(), sizeof(vCpuSet), &vCpuSet);
+    }
+
+    //A spinning real time worker would hold a shared core ahead of the caller,
+    //and without the right to real time scheduling it keeps the normal priority
+    if (aPinThread && aIndex + 1u < vCores)
+    {
+        sched_param vParam{};
+        vParam.sched_priority = (sched_get_priority_min(SCHED_FIFO) + sched_get_priority_max(SCHED_FIFO)) / 2;
+        pthread_setschedparam(pthread_self(), SCHED_FIFO, &vParam);
+    }
+#else
+    (void)aIndex;
+    (void)aPinThread;
+#endif
+
+    std::uint32_t vSeenGeneration = 0;
+    while (true)
+    {
+        std::uint32_t vGeneration = GetGeneration(mClaim.load(std::memory_order_acquire));
+        int vSpins = 0;
+        while (vGeneration == vSeenGeneration && !mIsStopping.load(std::memory_order_relaxed))
+        {
+            if (++vSpins < kSpinIterations)
+            {
+                CpuRelax();
+            }
+            else
+            {
+                //The sleepers count is read by ParallelFor after publishing a
+                //job, so either it wakes this thread or the wait sees the job
+                std::unique_lock<std::mutex> vLock(mMutex);
+                ++mSleepersNumber;
+                mWakeUp.wait(vLock, [this, vSeenGeneration]
+                    {
+                        return GetGeneration(mClaim.load()) != vSeenGeneration || mIsStopping.load();
+                    });
+                --mSleepersNumber;
+                vSpins = 0;
+            }
+            vGeneration = GetGeneration(mClaim.load(std::memory_order_acquire));
+        }
+        if (mIsStopping.load())
+        {
+            return;
+        }
+        vSeenGeneration = vGeneration;
+        RunItems(vGeneration, true);
+    }
+}
+
+int RealtimeWorkerGroup::RunItems(std::uint32_t aGeneration, bool aIsWorker)
+{
+    //The fields are read once the claim shows the job, which publishes them
+    std::uint64_t vClaim = mClaim.load(std::memory_order_acquire);
+    if (GetGeneration(vClaim) != aGeneration)
+    {
+        return 0;
+    }
+    const Function vFunction = mFunction.load(std::memory_order_relaxed);
+    void* const vpContext = mpContext.load(std::memory_order_relaxed);
+    const std::uint32_t vItemsNumber = static_cast<std::uint32_t>(mItemsNumber.load(std::memory_order_relaxed));
+#if FASTBOWEDSTRING_X86
+    //Same denormal flushing and rounding as the caller, e.g. the audio thread
+    if (aIsWorker)
+    {
+        _mm_setcsr(mFloatMode.load(std::memory_order_relaxed));
+    }
+#endif
+
+    //Pairs with the fence of ParallelFor: if the fields of the next job were
+    //read, the claim of this one is already closed and no item is claimed
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    //An item is claimed only while its job is the current one, so a late
+    //worker cannot take an item of the next job with the previous function
+    int vRunItems = 0;
+    while (GetGeneration(vClaim) == aGeneration && GetItem(vClaim) < vItemsNumber)
+    {
+        if (mClaim.compare_exchange_weak(vClaim, vClaim + 1, std::memory_order_acq_rel))
+        {
+            vFunction(vpContext, static_cast<int>(GetItem(vClaim)));
+            ++vRunItems;
+            if (aIsWorker)
+            {
+                mWorkerItems.fetch_add(1, std::memory_order_relaxed);
+            }
+            mDoneItems.fetch_add(1, std::memory_order_release);
+            vClaim = mClaim.load(std::memory_order_acquire);
+        }
+    }
+    return vRunItems;
+}
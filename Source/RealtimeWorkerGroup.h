@@ -0,0 +1,89 @@
+/*
+  ==============================================================================
+
+    RealtimeWorkerGroup.h
+    Created: 17/10/2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/*
+Persistent threads that help the audio thread inside the callback. ParallelFor
+hands out the items of a job one at a time through an atomic counter, to the
+workers and to the calling thread alike, so the caller never waits for an item
+that no worker has started: if the workers are late, e.g. not scheduled, the
+caller runs the remaining items itself and only waits for those in progress.
+
+Between jobs the workers spin for a while and then sleep on a condition
+variable. Waking them takes the mutex, which only happens for the first job
+after an idle period. On Linux the workers can be pinned to one core each.
+A pinned worker with a core of its own asks for the SCHED_FIFO policy in the
+middle of its priority range, so that other threads do not delay it inside the
+callback. If it is refused, e.g. without an rtprio limit, the worker silently
+keeps the normal priority, as do the workers sharing a core, whose spinning
+would otherwise hold the core ahead of the caller.
+The threads are started by the constructor and joined by the destructor,
+neither is real time safe.
+*/
+class RealtimeWorkerGroup
+{
+public:
+    //Called once for each item of a job, from any thread of the group
+    using Function = void (*)(void* apContext, int aItem);
+
+    RealtimeWorkerGroup(int aWorkersNumber, bool aPinThreads);
+    ~RealtimeWorkerGroup();
+
+    RealtimeWorkerGroup(const RealtimeWorkerGroup&) = delete;
+    RealtimeWorkerGroup& operator=(const RealtimeWorkerGroup&) = delete;
+
+    /*
+    Calls aFunction for every item in [0, aItemsNumber) and returns when all
+    the calls are done. Returns the number of items run by the workers. Only
+    one thread may call it at a time.
+    */
+    int ParallelFor(int aItemsNumber, Function aFunction, void* apContext);
+
+    int GetWorkersNumber() const { return static_cast<int>(mThreads.size()); }
+
+    //Workers available on this machine besides the calling thread
+    static int GetDefaultWorkersNumber();
+
+private:
+    //Checks of the job counter before a worker goes to sleep
+    static constexpr int kSpinIterations = 20000;
+
+    std::vector<std::thread> mThreads;
+
+    //Generation of the current job in the high 32 bits, next item in the low
+    //ones, all set while the next job is being written
+    std::atomic<std::uint64_t> mClaim{ 0 };
+    std::atomic<int> mItemsNumber{ 0 };
+    std::atomic<Function> mFunction{ nullptr };
+    std::atomic<void*> mpContext{ nullptr };
+
+    //Floating point control word of the caller, copied by the workers
+    std::atomic<unsigned> mFloatMode{ 0 };
+
+    alignas(64) std::atomic<int> mDoneItems{ 0 };
+    alignas(64) std::atomic<int> mWorkerItems{ 0 };
+
+    std::atomic<bool> mIsStopping{ false };
+    std::atomic<int> mSleepersNumber{ 0 };
+    std::mutex mMutex;
+    std::condition_variable mWakeUp;
+
+    void RunWorker(int aIndex, bool aPinThread);
+
+    //Runs items of the job aGeneration until none is left, returns how many
+    int RunItems(std::uint32_t aGeneration, bool aIsWorker);
+};
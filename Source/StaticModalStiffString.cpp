@@ -0,0 +1,58 @@
+/*
+  ==============================================================================
+
+    StaticModalStiffString.cpp
+    Created: 17/10/2026
+
+  ==============================================================================
+*/
+
+#include "StaticModalStiffString.h"
+
+namespace
+{
+    bool HasParams(const Global::Strings::String& aString, const Global::Strings::StringParams& aParams)
+    {
+        return aString.mRadius == aParams.mRadius
+            && aString.mDensity == aParams.mDensity
+            && aString.mTension == aParams.mTension
+            && aString.mYoungMod == aParams.mYoungMod
+            && aString.mLength == aParams.mLength;
+    }
+
+    template <const Global::Strings::StringParams& Params>
+    std::unique_ptr<ModalStringEngine> CreateForRate(double aSampleRate)
+    {
+        if (aSampleRate == 44100.0)
+        {
+            return std::make_unique<StaticModalStiffString<Params, 44100>>();
+        }
+        if (aSampleRate == 48000.0)
+        {
+            return std::make_unique<StaticModalStiffString<Params, 48000>>();
+        }
+        return nullptr;
+    }
+}
+
+std::unique_ptr<ModalStringEngine> CreateStaticModalStiffString(const Global::Strings::String& aString, double aSampleRate)
+{
+    using namespace Global::Strings;
+    if (HasParams(aString, kCelloA3Params))
+    {
+        return CreateForRate<kCelloA3Params>(aSampleRate);
+    }
+    if (HasParams(aString, kCelloD3Params))
+    {
+        return CreateForRate<kCelloD3Params>(aSampleRate);
+    }
+    if (HasParams(aString, kCelloG2Params))
+    {
+        return CreateForRate<kCelloG2Params>(aSampleRate);
+    }
+    if (HasParams(aString, kCelloC2Params))
+    {
+        return CreateForRate<kCelloC2Params>(aSampleRate);
+    }
+    return nullptr;
+}
@@ -0,0 +1,447 @@
+/*
+  ==============================================================================
+
+    StaticModalStiffString.h
+    Created: 17/10/2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cmath>
+#include <memory>
+#include "Global.h"
+#include "ModalStringEngine.h"
+#include "ModeShapes.h"
+#include "TripleBuffer.h"
+
+/*
+Modal stiff string specialised at compile time for one of the built-in presets
+and one sample rate. Eigenfrequencies, damping and the folded coefficients of
+ModalStringTables::PrecompileCoefficients are constexpr tables, and the
+per-mode loops run over a fixed number of modes, so that the compiler can
+unroll and vectorize them. Only the mode shapes, which depend on the bow and
+pickup positions, are computed at runtime.
+
+The physics is the one of ModalStiffStringProcessor, without the active modes
+set, whose changing trip count would defeat the specialisation. Use
+CreateStaticModalStiffString to get the engine of a string, falling back to
+ModalStiffStringProcessor when it returns nullptr.
+*/
+namespace StaticModalTables
+{
+    //Newton iterations, exact to the last bit of a double for aX >= 0
+    constexpr double Sqrt(double aX)
+    {
+        if (aX <= 0)
+        {
+            return 0;
+        }
+        double vRoot = aX > 1 ? aX : 1;
+        for (int i = 0; i < 100; ++i)
+        {
+            double vNext = 0.5 * (vRoot + aX / vRoot);
+            if (vNext >= vRoot)
+            {
+                break;
+            }
+            vRoot = vNext;
+        }
+        return vRoot;
+    }
+
+    /*
+    Same model as ModalStiffStringProcessor::ComputeEigenFreq and ComputeDampCoeff.
+    The dynamic engine does not read the Young modulus of the string, so the
+    stiffness terms are left out here too to keep the two engines equivalent.
+    */
+    constexpr double ComputeEigenFreq(const Global::Strings::StringParams& aParams, int aModeNumber)
+    {
+        double vArea = Global::kPi * aParams.mRadius * aParams.mRadius;
+        double vLinDensity = aParams.mDensity * vArea;
+        double vN = aModeNumber * Global::kPi / aParams.mLength;
+        return Sqrt(aParams.mTension / vLinDensity * vN * vN);
+    }
+
+    constexpr double ComputeDampCoeff(const Global::Strings::StringParams& aParams, double aFreq)
+    {
+        double vRhoAir = 1.225;
+        double vMuAir = 1.619e-5;
+        double vD0 = -2 * vRhoAir * vMuAir / (aParams.mDensity * aParams.mRadius * aParams.mRadius);
+        double vD1 = -2 * vRhoAir * Sqrt(2 * vMuAir) / (aParams.mDensity * aParams.mRadius);
+        return -(vD0 + vD1 * Sqrt(aFreq));
+    }
+
+    //Modes below 20kHz
+    constexpr int ComputeModesNumber(const Global::Strings::StringParams& aParams)
+    {
+        double vLimitFreq = 20e3 * 2 * Global::kPi;
+        int vModesNumber = 0;
+        while (ComputeEigenFreq(aParams, vModesNumber + 1) <= vLimitFreq)
+        {
+            ++vModesNumber;
+        }
+        return vModesNumber;
+    }
+
+    //Per-mode constant coefficients, zero padded to a whole cache line
+    template <int ModesStride>
+    struct alignas(64) Tables
+    {
+        float mEigenFreqs[ModesStride]{};
+        float mInvSchurComp[ModesStride]{};
+        float mVelDisplCoeffs[ModesStride]{};
+        float mVelVelCoeffs[ModesStride]{};
+        float mDecayM11[ModesStride]{};
+        float mDecayM12[ModesStride]{};
+        float mDecayM21[ModesStride]{};
+        float mDecayM22[ModesStride]{};
+    };
+
+    //See ModalStringTables::PrecompileCoefficients
+    template <int ModesStride>
+    constexpr Tables<ModesStride> MakeTables(const Global::Strings::StringParams& aParams, int aModesNumber, double aTimeStep)
+    {
+        Tables<ModesStride> vTables;
+        const double vHalfTimeStep = 0.5 * aTimeStep;
+        for (int i = 0; i < aModesNumber; ++i)
+        {
+            double vOmega = ComputeEigenFreq(aParams, i + 1);
+            double vOmegaSq = vOmega * vOmega;
+
+            double vA12 = -vHalfTimeStep;
+            double vA21 = vHalfTimeStep * vOmegaSq;
+            double vB12 = vHalfTimeStep;
+            double vB21 = -vHalfTimeStep * vOmegaSq;
+            double vB22 = 1 - aTimeStep * ComputeDampCoeff(aParams, vOmega);
+
+            double vInvSchurComp = 1 / (1 - vA21 * vA12);
+            double vVelDispl = (vB21 - vA21) * vInvSchurComp;
+            double vVelVel = (vB22 - vA21 * vB12) * vInvSchurComp;
+
+            vTables.mEigenFreqs[i] = static_cast<float>(vOmega);
+            vTables.mInvSchurComp[i] = static_cast<float>(vInvSchurComp);
+            vTables.mVelDisplCoeffs[i] = static_cast<float>(vVelDispl);
+            vTables.mVelVelCoeffs[i] = static_cast<float>(vVelVel);
+            vTables.mDecayM11[i] = static_cast<float>(1 + vHalfTimeStep * vVelDispl);
+            vTables.mDecayM12[i] = static_cast<float>(vHalfTimeStep * (1 + vVelVel));
+            vTables.mDecayM21[i] = static_cast<float>(vVelDispl);
+            vTables.mDecayM22[i] = static_cast<float>(vVelVel);
+        }
+        return vTables;
+    }
+}
+
+template <const Global::Strings::StringParams& Params, int SampleRate>
+class StaticModalStiffString final : public ModalStringEngine
+{
+public:
+    static constexpr int kModesNumber = StaticModalTables::ComputeModesNumber(Params);
+    static constexpr int kModesStride = (kModesNumber + 15) / 16 * 16;
+
+    //==========================================================================
+    StaticModalStiffString()
+    {
+        RecomputeInModes();
+        RecomputeOutModes();
+        mModesIn.Acquire();
+        mModesOut.Acquire();
+    }
+
+    //==========================================================================
+    void SetPlayState(bool aPlayState) override
+    {
+        mPlayState.store(aPlayState);
+    }
+
+    void ResetStringStates() override
+    {
+        mPlayState.store(false);
+        InitializeStates();
+    }
+
+    void SetInputPos(float aNewPos) override
+    {
+        if (aNewPos >= 0 && aNewPos <= 1)
+        {
+            mExcitPos = aNewPos * Params.mLength;
+        }
+        RecomputeInModes();
+    }
+
+    void SetReadPos(float aNewPos) override
+    {
+        if (aNewPos >= 0 && aNewPos <= 1)
+        {
+            mReadPos = aNewPos * Params.mLength;
+        }
+        RecomputeOutModes();
+    }
+
+    void SetGain(float aGain) override
+    {
+        mGain.store(aGain);
+    }
+
+    void SetBowPressure(float aPressure) override
+    {
+        mFb.store(aPressure);
+    }
+
+    void SetBowSpeed(float aSpeed) override
+    {
+        mVb.store(aSpeed);
+    }
+
+    void SetSleepEnergyFloor(float aEnergyFloor) override
+    {
+        mSleepEnergyFloor.store(aEnergyFloor);
+    }
+
+    bool ProcessBlock(float* apOutput, int aNumSamples) override
+    {
+        const float vFb = mFb.load();
+        if (!mPlayState.load() || (mIsSleeping && vFb == 0.f))
+        {
+            for (int n = 0; n < aNumSamples; ++n)
+            {
+                apOutput[n] = 0.f;
+            }
+            return false;
+        }
+        mIsSleeping = false;
+
+        //The last mode shapes published are read for the whole block
+        mModesIn.Acquire();
+        mModesOut.Acquire();
+        if (vFb == 0.f)
+        {
+            RenderFreeDecay(apOutput, aNumSamples);
+            if (ComputeEnergy() < mSleepEnergyFloor.load())
+            {
+                InitializeStates();
+                mIsSleeping = true;
+            }
+        }
+        else
+        {
+            RenderBowed(vFb, apOutput, aNumSamples);
+        }
+        return true;
+    }
+
+    int GetModesNumber() override
+    {
+        return kModesNumber;
+    }
+
+private:
+    //==========================================================================
+    static constexpr double kTimeStep = 1.0 / SampleRate;
+    static constexpr StaticModalTables::Tables<kModesStride> kTables =
+        StaticModalTables::MakeTables<kModesStride>(Params, kModesNumber, kTimeStep);
+
+    //Independent partial sums, so that the reductions can be vectorized
+    static constexpr int kLanes = 16;
+
+    std::atomic<bool> mPlayState{ false };
+    std::atomic<float> mGain{ 0.f };
+    std::atomic<float> mFb{ 0.f };
+    std::atomic<float> mVb{ 0.f };
+    std::atomic<float> mSleepEnergyFloor{ 1e-12f };
+    bool mIsSleeping{ false };
+
+    float mA{ 100.f };
+    float mExcitPos{ 0.f };
+    float mReadPos{ 0.f };
+
+    /*
+    Mode shapes, triple buffered as in ModalStiffStringProcessor, so that they
+    can be recomputed at any rate while the audio thread reads them. Indices
+    are used instead of pointers so that the compiler sees that the mode shapes
+    and the states never alias.
+    */
+    struct alignas(64) ModesIn
+    {
+        float mW[kModesStride]{};
+        float mG[kModesStride]{};   //w / SchurComp
+    };
+    struct alignas(64) ModesOut
+    {
+        float mO[kModesStride]{};
+    };
+    ModesIn mModesInBuffers[3];
+    ModesOut mModesOutBuffers[3];
+    TripleBuffer mModesIn;
+    TripleBuffer mModesOut;
+
+    //String states and free response scratch
+    alignas(64) float mDispl[kModesStride]{};
+    alignas(64) float mVel[kModesStride]{};
+    alignas(64) float mFreeVel[kModesStride]{};
+
+    //==========================================================================
+    static float Sum(const float* apLanes)
+    {
+        float vSum = 0.f;
+        for (int l = 0; l < kLanes; ++l)
+        {
+            vSum += apLanes[l];
+        }
+        return vSum;
+    }
+
+    void RecomputeInModes()
+    {
+        //Computing new modes in the buffer not read by the audio thread
+        ModesIn& vModesIn = mModesInBuffers[mModesIn.GetWriteIndex()];
+        ModeShapes::Compute(mExcitPos, Params.mLength, vModesIn.mW, kModesNumber);
+        for (int i = 0; i < kModesNumber; ++i)
+        {
+            vModesIn.mG[i] = vModesIn.mW[i] * kTables.mInvSchurComp[i];
+        }
+        mModesIn.Publish();
+    }
+
+    void RecomputeOutModes()
+    {
+        ModesOut& vModesOut = mModesOutBuffers[mModesOut.GetWriteIndex()];
+        ModeShapes::Compute(mReadPos, Params.mLength, vModesOut.mO, kModesNumber);
+        mModesOut.Publish();
+    }
+
+    void InitializeStates()
+    {
+        for (int i = 0; i < kModesStride; ++i)
+        {
+            mDispl[i] = 0.f;
+            mVel[i] = 0.f;
+        }
+    }
+
+    float ComputeEnergy()
+    {
+        float vLanes[kLanes]{};
+        for (int i = 0; i < kModesStride; i += kLanes)
+        {
+            for (int l = 0; l < kLanes; ++l)
+            {
+                float vOmegaDispl = kTables.mEigenFreqs[i + l] * mDispl[i + l];
+                vLanes[l] += vOmegaDispl * vOmegaDispl + mVel[i + l] * mVel[i + l];
+            }
+        }
+        return 0.5f * Sum(vLanes);
+    }
+
+    //The padding modes have zero coefficients and mode shapes, so the loops
+    //run over the whole stride and leave their states at zero
+    void RenderBowed(float aFb, float* apOutput, int aNumSamples)
+    {
+        const ModesIn& vModesIn = mModesInBuffers[mModesIn.GetReadIndex()];
+        const ModesOut& vModesOut = mModesOutBuffers[mModesOut.GetReadIndex()];
+        const float vVb = mVb.load();
+        const float vGain = mGain.load();
+
+        const float vSqrt2A = sqrt(2 * mA);
+        const float vHalfTimeStep = static_cast<float>(0.5 * kTimeStep);
+        const float vHalfKFb = static_cast<float>(0.5 * kTimeStep * aFb);
+        const float vKFbVb = static_cast<float>(kTimeStep * aFb * vVb);
+
+        float vLanes[kLanes]{};
+        float vOutLanes[kLanes]{};
+        for (int i = 0; i < kModesStride; i += kLanes)
+        {
+            for (int l = 0; l < kLanes; ++l)
+            {
+                vLanes[l] += vModesIn.mW[i + l] * vModesIn.mG[i + l];
+                vOutLanes[l] += vModesIn.mW[i + l] * mVel[i + l];
+            }
+        }
+        const float vInSchurProjection = Sum(vLanes);
+        float vZeta1 = Sum(vOutLanes);
+
+        for (int n = 0; n < aNumSamples; ++n)
+        {
+            //Computing bow input
+            float vEta = vZeta1 - vVb;
+            float vD = vSqrt2A * exp(-mA * vEta * vEta + 0.5f);
+            float vLambda = vD * (1 - 2 * mA * vEta * vEta);
+            float vZeta1Coeff = vHalfKFb * (vLambda - 2 * vD) * vZeta1 + vKFbVb * vD;
+            float vZ1Coeff = vHalfKFb * vLambda;
+
+            //Free response and its input projection
+            for (int l = 0; l < kLanes; ++l)
+            {
+                vLanes[l] = 0.f;
+            }
+            for (int i = 0; i < kModesStride; i += kLanes)
+            {
+                for (int l = 0; l < kLanes; ++l)
+                {
+                    float vFreeVel = kTables.mVelDisplCoeffs[i + l] * mDispl[i + l] + kTables.mVelVelCoeffs[i + l] * mVel[i + l];
+                    mFreeVel[i + l] = vFreeVel;
+                    vLanes[l] += vModesIn.mW[i + l] * vFreeVel;
+                }
+            }
+
+            //Sherman-Morrison correction
+            float vVt1 = vZ1Coeff * vInSchurProjection;
+            float vVt2 = Sum(vLanes) + vZeta1Coeff * vInSchurProjection;
+            float vBowTerm = vZeta1Coeff - vZ1Coeff * vVt2 / (1 + vVt1);
+
+            //Writing the new states with the projections for the next sample
+            for (int l = 0; l < kLanes; ++l)
+            {
+                vLanes[l] = 0.f;
+                vOutLanes[l] = 0.f;
+            }
+            for (int i = 0; i < kModesStride; i += kLanes)
+            {
+                for (int l = 0; l < kLanes; ++l)
+                {
+                    float vNextVel = mFreeVel[i + l] + vModesIn.mG[i + l] * vBowTerm;
+                    float vNextDispl = mDispl[i + l] + vHalfTimeStep * (mVel[i + l] + vNextVel);
+                    mDispl[i + l] = vNextDispl;
+                    mVel[i + l] = vNextVel;
+                    vLanes[l] += vModesIn.mW[i + l] * vNextVel;
+                    vOutLanes[l] += vModesOut.mO[i + l] * vNextDispl;
+                }
+            }
+            vZeta1 = Sum(vLanes);
+            apOutput[n] = vGain * Sum(vOutLanes);
+        }
+    }
+
+    void RenderFreeDecay(float* apOutput, int aNumSamples)
+    {
+        const ModesOut& vModesOut = mModesOutBuffers[mModesOut.GetReadIndex()];
+        const float vGain = mGain.load();
+
+        for (int n = 0; n < aNumSamples; ++n)
+        {
+            float vOutLanes[kLanes]{};
+            for (int i = 0; i < kModesStride; i += kLanes)
+            {
+                for (int l = 0; l < kLanes; ++l)
+                {
+                    float vDispl = mDispl[i + l];
+                    float vVel = mVel[i + l];
+                    float vNextDispl = kTables.mDecayM11[i + l] * vDispl + kTables.mDecayM12[i + l] * vVel;
+                    mVel[i + l] = kTables.mDecayM21[i + l] * vDispl + kTables.mDecayM22[i + l] * vVel;
+                    mDispl[i + l] = vNextDispl;
+                    vOutLanes[l] += vModesOut.mO[i + l] * vNextDispl;
+                }
+            }
+            apOutput[n] = vGain * Sum(vOutLanes);
+        }
+    }
+};
+
+/*
+Returns the engine specialised for aString at aSampleRate, or nullptr if there
+is none, i.e. aString is not one of the built-in presets or the sample rate is
+not 44.1kHz or 48kHz.
+*/
+std::unique_ptr<ModalStringEngine> CreateStaticModalStiffString(const Global::Strings::String& aString, double aSampleRate);
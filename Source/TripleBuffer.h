@@ -0,0 +1,54 @@
+/*
+  ==============================================================================
+
+    TripleBuffer.h
+    Created: 17/10/2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <atomic>
+
+/*
+Indices of three buffers shared by one writer and one reader thread. The
+writer fills the write buffer and publishes it, taking back the spare one, and
+the reader acquires the last published buffer, giving back the one it was
+reading. Neither side ever waits nor touches the buffer of the other, and the
+buffers published between two acquisitions are coalesced into the last one.
+The buffers themselves are owned by the caller.
+*/
+class TripleBuffer
+{
+public:
+    //Writer side
+    int GetWriteIndex() const { return mWriteIndex; }
+
+    void Publish()
+    {
+        mWriteIndex = mSpare.exchange(mWriteIndex | kFreshFlag, std::memory_order_acq_rel) & kIndexMask;
+    }
+
+    //Reader side
+    int GetReadIndex() const { return mReadIndex; }
+
+    //Returns false and keeps the read buffer if nothing was published since the last call
+    bool Acquire()
+    {
+        if ((mSpare.load(std::memory_order_relaxed) & kFreshFlag) == 0)
+        {
+            return false;
+        }
+        mReadIndex = mSpare.exchange(mReadIndex, std::memory_order_acq_rel) & kIndexMask;
+        return true;
+    }
+
+private:
+    static constexpr int kIndexMask = 3;
+    static constexpr int kFreshFlag = 4;
+
+    int mWriteIndex{ 0 };
+    std::atomic<int> mSpare{ 1 };
+    int mReadIndex{ 2 };
+};
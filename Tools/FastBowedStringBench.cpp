@@ -0,0 +1,561 @@
+/*
+  ==============================================================================
+
+    FastBowedStringBench.cpp
+    Created: 17/10/2026
+
+  ==============================================================================
+*/
+
+/*
+Headless benchmark of the string engines. Each engine renders a bowed note for
+a number of seconds at every requested sample rate and block size, the result
+of each run is written as a JSON object with the time per sample, the real time
+factor (processing time over audio time) and the percentiles of the block
+times.
+
+Usage:
+    FastBowedStringBench [--seconds 2] [--rates 44100,48000,96000,192000]
+                         [--blocks 64,256,1024]
+                         [--engines modal,modal-moving,modal-pickups,modal-static,modal-batch,voices,ref,opt,optvec]
+                         [--note-rate 200] [--voice-workers 0]
+                         [--presets CelloA3,...] [--isa scalar|sse2|avx2|avx512]
+                         [--max-run-seconds 10] [--output results.json]
+
+The time domain engines do not depend on the preset, so they run once per
+sample rate and block size, with the preset reported as "TimeDomain" and the
+grid points as modes. Their cost grows with the square of the grid size, so
+--max-run-seconds stops a run early when its processing time exceeds the limit
+and only the rendered samples are reported.
+
+The modal-moving engine is the modal one with the bow moving between sul tasto
+and sul ponticello, following a per-sample position buffer.
+
+The modal-pickups engine is the modal one read by kBenchPickups pickups spread
+along the string, rendered at once by the multichannel ProcessBlock. Only the
+first pickup is kept, its time is that of all the pickups.
+
+The modal-batch engine renders ModalKernels::kBatchLanes copies of the preset
+with a ModalStringBatch, its times and modes are those of all the copies.
+
+The voices engine plays --note-rate notes per second on a ModalVoicePool, each
+held for four notes, posted through its command queue. It runs once per sample
+rate and block size with the preset reported as "Voices" and the voices number
+as modes, the block time percentiles show the cost of the note ons. With
+--voice-workers the pool renders on that many worker threads besides the bench
+thread, with kDefaultVoicesNumber voices per thread.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+#include <BenchTimer.h>
+#include "ToolsCommon.h"
+#include "Bowed1DWaveFirstOrder.h"
+#include "ModalStiffStringProcessor.h"
+#include "ModalStringBatch.h"
+#include "ModalVoicePool.h"
+#include "StaticModalStiffString.h"
+
+namespace
+{
+    //On Windows the real timer has millisecond resolution, the cpu timer uses
+    //the performance counter
+#if defined(_WIN32) || defined(__CYGWIN__)
+    constexpr int kBlockTimer = Eigen::CPU_TIMER;
+#else
+    constexpr int kBlockTimer = Eigen::REAL_TIMER;
+#endif
+
+    //Bowed note used for every run, the moving bow swings around kInputPos
+    constexpr float kBowPressure = 10.f;
+    constexpr float kBowSpeed = 0.2f;
+    constexpr float kInputPos = 0.733f;
+    constexpr float kReadPos = 0.53f;
+    constexpr float kGain = 1000.f;
+    constexpr float kTimeDomainReadPos = 0.8f;
+    constexpr double kBowSwingHz = 0.5;
+    constexpr float kBowSwing = 0.2f;
+
+    //Pickups of the modal-pickups engine, e.g. a quadraphonic string
+    constexpr int kBenchPickups = 4;
+
+    //Common interface of the engines under test
+    class BenchEngine
+    {
+    public:
+        virtual ~BenchEngine() = default;
+        virtual void Render(float* apOutput, int aNumSamples) = 0;
+        virtual int GetSize() = 0;
+    };
+
+    class ModalBenchEngine : public BenchEngine
+    {
+    public:
+        explicit ModalBenchEngine(std::unique_ptr<ModalStringEngine> apEngine)
+            : mpEngine(std::move(apEngine))
+        {
+            mpEngine->SetInputPos(kInputPos);
+            mpEngine->SetReadPos(kReadPos);
+            mpEngine->SetGain(kGain);
+            mpEngine->SetBowSpeed(kBowSpeed);
+            mpEngine->SetBowPressure(kBowPressure);
+            mpEngine->SetPlayState(true);
+        }
+
+        void Render(float* apOutput, int aNumSamples) override
+        {
+            mpEngine->ProcessBlock(apOutput, aNumSamples);
+        }
+
+        int GetSize() override
+        {
+            return mpEngine->GetModesNumber();
+        }
+
+    private:
+        std::unique_ptr<ModalStringEngine> mpEngine;
+    };
+
+    class MovingBowBenchEngine : public BenchEngine
+    {
+    public:
+        MovingBowBenchEngine(double aSampleRate, std::unique_ptr<ModalStiffStringProcessor> apProcessor)
+            : mpProcessor(std::move(apProcessor)), mPhaseStep(2 * Global::kPi * kBowSwingHz / aSampleRate)
+        {
+            mpProcessor->SetInputPos(kInputPos);
+            mpProcessor->SetReadPos(kReadPos);
+            mpProcessor->SetGain(kGain);
+            mpProcessor->SetBowSpeed(kBowSpeed);
+            mpProcessor->SetBowPressure(kBowPressure);
+            mpProcessor->SetPlayState(true);
+        }
+
+        void Render(float* apOutput, int aNumSamples) override
+        {
+            mPositions.resize(aNumSamples);
+            for (int n = 0; n < aNumSamples; ++n)
+            {
+                mPositions[n] = kInputPos - kBowSwing * static_cast<float>(std::sin(mPhase));
+                mPhase += mPhaseStep;
+            }
+            mpProcessor->ProcessBlock(apOutput, aNumSamples, mPositions.data());
+        }
+
+        int GetSize() override
+        {
+            return mpProcessor->GetModesNumber();
+        }
+
+    private:
+        std::unique_ptr<ModalStiffStringProcessor> mpProcessor;
+        std::vector<float> mPositions;
+        double mPhase{ 0.0 };
+        double mPhaseStep;
+    };
+
+    class PickupsBenchEngine : public BenchEngine
+    {
+    public:
+        explicit PickupsBenchEngine(std::unique_ptr<ModalStiffStringProcessor> apProcessor)
+            : mpProcessor(std::move(apProcessor))
+        {
+            mpProcessor->SetPickupsNumber(kBenchPickups);
+            mpProcessor->SetInputPos(kInputPos);
+            mpProcessor->SetReadPos(kReadPos);
+            for (int k = 1; k < kBenchPickups; ++k)
+            {
+                mpProcessor->SetPickupPos(k, static_cast<float>(k) / kBenchPickups);
+            }
+            mpProcessor->SetGain(kGain);
+            mpProcessor->SetBowSpeed(kBowSpeed);
+            mpProcessor->SetBowPressure(kBowPressure);
+            mpProcessor->SetPlayState(true);
+        }
+
+        void Render(float* apOutput, int aNumSamples) override
+        {
+            mOutputs.resize(static_cast<std::size_t>(kBenchPickups - 1) * aNumSamples);
+            float* vpOutputs[kBenchPickups] = { apOutput };
+            for (int k = 1; k < kBenchPickups; ++k)
+            {
+                vpOutputs[k] = mOutputs.data() + static_cast<std::size_t>(k - 1) * aNumSamples;
+            }
+            mpProcessor->ProcessBlock(vpOutputs, kBenchPickups, aNumSamples);
+        }
+
+        int GetSize() override
+        {
+            return mpProcessor->GetModesNumber();
+        }
+
+    private:
+        std::unique_ptr<ModalStiffStringProcessor> mpProcessor;
+        std::vector<float> mOutputs;
+    };
+
+    class BatchBenchEngine : public BenchEngine
+    {
+    public:
+        BatchBenchEngine(double aSampleRate, Global::Strings::String* apString, ModalKernels::Isa aIsa)
+            : mBatch(std::vector<std::shared_ptr<const ModalStringTables>>(ModalKernels::kBatchLanes,
+                ModalStringTables::Create(*apString, aSampleRate)))
+        {
+            mBatch.SetKernelIsa(aIsa);
+            for (int s = 0; s < mBatch.GetStringsNumber(); ++s)
+            {
+                mBatch.SetInputPos(s, kInputPos);
+                mBatch.SetReadPos(s, kReadPos);
+                mBatch.SetGain(s, kGain);
+                mBatch.SetBowSpeed(s, kBowSpeed);
+                mBatch.SetBowPressure(s, kBowPressure);
+            }
+            mOutputs.resize(mBatch.GetStringsNumber());
+            mpOutputs.resize(mBatch.GetStringsNumber());
+        }
+
+        //The first string is written in apOutput, the others in scratch buffers
+        void Render(float* apOutput, int aNumSamples) override
+        {
+            mpOutputs[0] = apOutput;
+            for (size_t s = 1; s < mOutputs.size(); ++s)
+            {
+                mOutputs[s].resize(aNumSamples);
+                mpOutputs[s] = mOutputs[s].data();
+            }
+            mBatch.ProcessBlock(mpOutputs.data(), aNumSamples);
+        }
+
+        int GetSize() override
+        {
+            return mBatch.GetPaddedModesNumber();
+        }
+
+    private:
+        ModalStringBatch mBatch;
+        std::vector<std::vector<float>> mOutputs;
+        std::vector<float*> mpOutputs;
+    };
+
+    class VoicePoolBenchEngine : public BenchEngine
+    {
+    public:
+        VoicePoolBenchEngine(double aSampleRate, double aNoteRate, int aWorkersNumber)
+            : mSampleRate(aSampleRate), mNoteRate(aNoteRate)
+        {
+            mPool.SetWorkersNumber(aWorkersNumber);
+            mPool.SetVoicesNumber(ModalVoicePool::kDefaultVoicesNumber * (1 + aWorkersNumber));
+            mPool.Prepare(aSampleRate);
+            mPool.SetInputPos(kInputPos);
+            mPool.SetReadPos(kReadPos);
+            mPool.SetGain(kGain);
+            mPool.SetBowPressure(kBowPressure);
+            mPool.SetBowSpeed(kBowSpeed);
+        }
+
+        //The notes due in the block are posted at its start
+        void Render(float* apOutput, int aNumSamples) override
+        {
+            long long vNotes = static_cast<long long>((mSamples + aNumSamples) * mNoteRate / mSampleRate);
+            for (; mNotes < vNotes; ++mNotes)
+            {
+                mPool.PostNoteOn(GetNote(mNotes), 0.8f);
+                if (mNotes >= kHeldNotes)
+                {
+                    mPool.PostNoteOff(GetNote(mNotes - kHeldNotes));
+                }
+            }
+            mPool.ProcessBlock(apOutput, aNumSamples);
+            mSamples += aNumSamples;
+        }
+
+        int GetSize() override
+        {
+            return mPool.GetVoicesNumber();
+        }
+
+    private:
+        static constexpr int kHeldNotes = 4;
+
+        ModalVoicePool mPool;
+        double mSampleRate;
+        double mNoteRate;
+        long long mSamples{ 0 };
+        long long mNotes{ 0 };
+
+        //Walks the range by fifths
+        int GetNote(long long aIndex) const
+        {
+            int vRange = mPool.GetHighestNote() - mPool.GetLowestNote() + 1;
+            return mPool.GetLowestNote() + static_cast<int>((aIndex * 7) % vRange);
+        }
+    };
+
+    enum class TimeDomainScheme
+    {
+        Ref,
+        Opt,
+        OptVec
+    };
+
+    class TimeDomainBenchEngine : public BenchEngine
+    {
+    public:
+        TimeDomainBenchEngine(double aSampleRate, TimeDomainScheme aScheme)
+            : mString(1.0 / aSampleRate), mScheme(aScheme)
+        {
+            mReadIndex = mString.getNumGridPoints() + static_cast<int>(std::floor(kTimeDomainReadPos * mString.getNumGridPoints()));
+        }
+
+        void Render(float* apOutput, int aNumSamples) override
+        {
+            for (int n = 0; n < aNumSamples; ++n)
+            {
+                switch (mScheme)
+                {
+                case TimeDomainScheme::Ref:
+                    mString.calculateFirstOrderRef();
+                    apOutput[n] = static_cast<float>(mString.getRefState()[mReadIndex]);
+                    break;
+                case TimeDomainScheme::Opt:
+                    mString.calculateFirstOrderOpt();
+                    apOutput[n] = static_cast<float>(mString.getOptState()[mReadIndex]);
+                    break;
+                case TimeDomainScheme::OptVec:
+                    mString.calculateFirstOrderOptVec();
+                    apOutput[n] = mString.getOutput(kTimeDomainReadPos);
+                    break;
+                }
+            }
+        }
+
+        int GetSize() override
+        {
+            return mString.getNumGridPoints();
+        }
+
+    private:
+        Bowed1DWaveFirstOrder mString;
+        TimeDomainScheme mScheme;
+        int mReadIndex{ 0 };
+    };
+
+    struct RunResult
+    {
+        long long mSamples{ 0 };
+        double mSeconds{ 0.0 };
+        std::vector<double> mBlockSeconds;
+        bool mIsTruncated{ false };
+    };
+
+    RunResult Run(BenchEngine& aEngine, double aSampleRate, int aBlockSize, double aSeconds, double aMaxRunSeconds)
+    {
+        RunResult vResult;
+        std::vector<float> vOutput(aBlockSize);
+        long long vTotalSamples = static_cast<long long>(aSeconds * aSampleRate);
+        vResult.mBlockSeconds.reserve(static_cast<size_t>(vTotalSamples / aBlockSize + 1));
+
+        Eigen::BenchTimer vTimer;
+        while (vResult.mSamples < vTotalSamples)
+        {
+            int vNumSamples = static_cast<int>(std::min<long long>(aBlockSize, vTotalSamples - vResult.mSamples));
+
+            vTimer.start();
+            aEngine.Render(vOutput.data(), vNumSamples);
+            vTimer.stop();
+
+            //Keeps the output alive
+            escape(vOutput.data());
+
+            double vBlockSeconds = vTimer.value(kBlockTimer);
+            vResult.mBlockSeconds.push_back(vBlockSeconds);
+            vResult.mSeconds += vBlockSeconds;
+            vResult.mSamples += vNumSamples;
+
+            if (aMaxRunSeconds > 0.0 && vResult.mSeconds > aMaxRunSeconds && vResult.mSamples < vTotalSamples)
+            {
+                vResult.mIsTruncated = true;
+                break;
+            }
+        }
+        return vResult;
+    }
+
+    //Nearest rank percentile of a sorted vector
+    double Percentile(const std::vector<double>& aSorted, double aPercent)
+    {
+        if (aSorted.empty())
+        {
+            return 0.0;
+        }
+        size_t vRank = static_cast<size_t>(std::ceil(aPercent / 100.0 * aSorted.size()));
+        return aSorted[std::min(aSorted.size(), std::max<size_t>(vRank, 1)) - 1];
+    }
+
+    void WriteResult(Tools::JsonWriter& aJson, const std::string& aEngine, const std::string& aPreset,
+        double aSampleRate, int aBlockSize, int aSize, RunResult& aResult)
+    {
+        std::sort(aResult.mBlockSeconds.begin(), aResult.mBlockSeconds.end());
+        double vAudioSeconds = aResult.mSamples / aSampleRate;
+
+        aJson.BeginObject();
+        aJson.Field("engine", aEngine);
+        aJson.Field("preset", aPreset);
+        aJson.Field("sample_rate", aSampleRate);
+        aJson.Field("block_size", aBlockSize);
+        aJson.Field("modes", aSize);
+        aJson.Field("samples", aResult.mSamples);
+        aJson.Field("truncated", aResult.mIsTruncated);
+        aJson.Field("seconds", aResult.mSeconds);
+        aJson.Field("ns_per_sample", aResult.mSamples > 0 ? 1e9 * aResult.mSeconds / aResult.mSamples : 0.0);
+        aJson.Field("real_time_factor", vAudioSeconds > 0.0 ? aResult.mSeconds / vAudioSeconds : 0.0);
+        aJson.Field("block_p50_us", 1e6 * Percentile(aResult.mBlockSeconds, 50.0));
+        aJson.Field("block_p99_us", 1e6 * Percentile(aResult.mBlockSeconds, 99.0));
+        aJson.Field("block_max_us", aResult.mBlockSeconds.empty() ? 0.0 : 1e6 * aResult.mBlockSeconds.back());
+        aJson.EndObject();
+    }
+
+    bool Contains(const std::vector<std::string>& aList, const std::string& aItem)
+    {
+        return std::find(aList.begin(), aList.end(), aItem) != aList.end();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Tools::Arguments vArgs(argc, argv);
+    double vSeconds = vArgs.GetDouble("seconds", 2.0);
+    double vMaxRunSeconds = vArgs.GetDouble("max-run-seconds", 10.0);
+    std::vector<double> vRates = vArgs.GetDoubleList("rates", "44100,48000,96000,192000");
+    std::vector<double> vBlocks = vArgs.GetDoubleList("blocks", "64,256,1024");
+    std::vector<std::string> vEngines = vArgs.GetList("engines", "modal,modal-moving,modal-pickups,modal-static,modal-batch,voices,ref,opt,optvec");
+    std::vector<std::string> vPresets = vArgs.GetList("presets", "");
+    double vNoteRate = vArgs.GetDouble("note-rate", 200.0);
+    int vVoiceWorkers = std::max(static_cast<int>(vArgs.GetDouble("voice-workers", 0.0)), 0);
+
+    ModalKernels::Isa vIsa = ModalKernels::GetBestSupportedIsa();
+    if (vArgs.Has("isa"))
+    {
+        if (!Tools::ParseIsa(vArgs.GetString("isa", ""), vIsa) || !ModalKernels::IsSupported(vIsa))
+        {
+            std::cerr << "Unsupported instruction set " << vArgs.GetString("isa", "") << std::endl;
+            return 1;
+        }
+    }
+
+    std::ofstream vFile;
+    if (vArgs.Has("output"))
+    {
+        vFile.open(vArgs.GetString("output", ""));
+        if (!vFile)
+        {
+            std::cerr << "Cannot open " << vArgs.GetString("output", "") << std::endl;
+            return 1;
+        }
+    }
+    Tools::JsonWriter vJson(vFile.is_open() ? static_cast<std::ostream&>(vFile) : std::cout);
+
+    vJson.BeginObject();
+    vJson.Field("seconds", vSeconds);
+    vJson.Field("isa", ModalKernels::GetIsaName(vIsa));
+    vJson.Key("results");
+    vJson.BeginArray();
+
+    for (double vRate : vRates)
+    {
+        for (double vBlock : vBlocks)
+        {
+            int vBlockSize = static_cast<int>(vBlock);
+            if (vBlockSize <= 0)
+            {
+                continue;
+            }
+
+            for (auto& vPreset : Tools::GetPresets())
+            {
+                std::string vName = vPreset.mpParams->mName;
+                if (!vPresets.empty() && !Contains(vPresets, vName))
+                {
+                    continue;
+                }
+
+                if (Contains(vEngines, "modal"))
+                {
+                    auto vpProcessor = std::make_unique<ModalStiffStringProcessor>(vRate, vPreset.mpString);
+                    vpProcessor->SetKernelIsa(vIsa);
+                    ModalBenchEngine vEngine(std::move(vpProcessor));
+                    RunResult vResult = Run(vEngine, vRate, vBlockSize, vSeconds, vMaxRunSeconds);
+                    WriteResult(vJson, "modal", vName, vRate, vBlockSize, vEngine.GetSize(), vResult);
+                }
+
+                if (Contains(vEngines, "modal-moving"))
+                {
+                    auto vpProcessor = std::make_unique<ModalStiffStringProcessor>(vRate, vPreset.mpString);
+                    vpProcessor->SetKernelIsa(vIsa);
+                    MovingBowBenchEngine vEngine(vRate, std::move(vpProcessor));
+                    RunResult vResult = Run(vEngine, vRate, vBlockSize, vSeconds, vMaxRunSeconds);
+                    WriteResult(vJson, "modal-moving", vName, vRate, vBlockSize, vEngine.GetSize(), vResult);
+                }
+
+                if (Contains(vEngines, "modal-pickups"))
+                {
+                    auto vpProcessor = std::make_unique<ModalStiffStringProcessor>(vRate, vPreset.mpString);
+                    vpProcessor->SetKernelIsa(vIsa);
+                    PickupsBenchEngine vEngine(std::move(vpProcessor));
+                    RunResult vResult = Run(vEngine, vRate, vBlockSize, vSeconds, vMaxRunSeconds);
+                    WriteResult(vJson, "modal-pickups", vName, vRate, vBlockSize, vEngine.GetSize(), vResult);
+                }
+
+                if (Contains(vEngines, "modal-static"))
+                {
+                    //Only specialised for the common sample rates
+                    auto vpStatic = CreateStaticModalStiffString(*vPreset.mpString, vRate);
+                    if (vpStatic)
+                    {
+                        ModalBenchEngine vEngine(std::move(vpStatic));
+                        RunResult vResult = Run(vEngine, vRate, vBlockSize, vSeconds, vMaxRunSeconds);
+                        WriteResult(vJson, "modal-static", vName, vRate, vBlockSize, vEngine.GetSize(), vResult);
+                    }
+                }
+
+                if (Contains(vEngines, "modal-batch"))
+                {
+                    BatchBenchEngine vEngine(vRate, vPreset.mpString, vIsa);
+                    RunResult vResult = Run(vEngine, vRate, vBlockSize, vSeconds, vMaxRunSeconds);
+                    WriteResult(vJson, "modal-batch", vName, vRate, vBlockSize, vEngine.GetSize(), vResult);
+                }
+            }
+
+            if (Contains(vEngines, "voices"))
+            {
+                VoicePoolBenchEngine vEngine(vRate, vNoteRate, vVoiceWorkers);
+                RunResult vResult = Run(vEngine, vRate, vBlockSize, vSeconds, vMaxRunSeconds);
+                WriteResult(vJson, "voices", "Voices", vRate, vBlockSize, vEngine.GetSize(), vResult);
+            }
+
+            const std::pair<const char*, TimeDomainScheme> kSchemes[] = {
+                { "ref", TimeDomainScheme::Ref },
+                { "opt", TimeDomainScheme::Opt },
+                { "optvec", TimeDomainScheme::OptVec } };
+            for (auto& vScheme : kSchemes)
+            {
+                if (!Contains(vEngines, vScheme.first))
+                {
+                    continue;
+                }
+                TimeDomainBenchEngine vEngine(vRate, vScheme.second);
+                RunResult vResult = Run(vEngine, vRate, vBlockSize, vSeconds, vMaxRunSeconds);
+                WriteResult(vJson, vScheme.first, "TimeDomain", vRate, vBlockSize, vEngine.GetSize(), vResult);
+            }
+        }
+    }
+
+    vJson.EndArray();
+    vJson.EndObject();
+    return 0;
+}
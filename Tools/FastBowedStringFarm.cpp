@@ -0,0 +1,419 @@
+/*
+  ==============================================================================
+
+    FastBowedStringFarm.cpp
+    Created: 17/10/2026
+
+  ==============================================================================
+*/
+
+/*
+Batch renderer for parameter sweeps and dataset generation. A list of jobs,
+each a string, sample rate, bow pressure, bow speed, input and read position,
+is rendered by a work-stealing thread pool (Eigen's NonBlockingThreadPool),
+one file per job.
+
+Usage:
+    FastBowedStringFarm --output-dir renders [--jobs jobs.csv]
+                        [--strings CelloA3,...] [--sample-rates 44100]
+                        [--pressures 10] [--speeds 0.2] [--inputs 0.733]
+                        [--reads 0.53] [--duration 2] [--release 0.5]
+                        [--gain 1000] [--block 512] [--threads N]
+                        [--format wav|raw] [--isa avx2] [--no-limit]
+                        [--report report.json]
+
+Without --jobs the jobs are the Cartesian product of the comma separated
+lists, in the order string, sample rate, pressure, speed, input, read. With
+--jobs they are read from a CSV file with one job per line,
+
+    string,sample_rate,pressure,speed,input,read[,duration]
+
+where lines starting with # and a header line starting with "string" are
+skipped, and a missing duration is the one of --duration. Each job bows the
+string for its duration and then lets it ring for --release seconds.
+
+Jobs of the same string and sample rate share one ModalStringTables. Every job
+renders with its own engine, a fixed kernel and a fixed block size, so the
+output of a job does not depend on the number of threads nor on the order in
+which the jobs run. The files are named <index>_<string>_<sample rate> and
+listed in manifest.csv in the output directory, together with a hash of the
+samples. A JSON report with the throughput is written to --report, or else
+to the standard output.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <unsupported/Eigen/CXX11/ThreadPool>
+#include "ToolsCommon.h"
+#include "ModalStiffStringProcessor.h"
+#include "ModalStringTables.h"
+
+namespace
+{
+    struct Job
+    {
+        const Tools::Preset* mpPreset;
+        double mSampleRate;
+        float mPressure;
+        float mSpeed;
+        float mInputPos;
+        float mReadPos;
+        double mDuration;
+    };
+
+    struct JobResult
+    {
+        std::string mFileName;
+        std::uint64_t mHash{ 0 };
+        double mSeconds{ 0.0 };
+        bool mIsWritten{ false };
+    };
+
+    //Options shared by every job
+    struct RenderOptions
+    {
+        double mRelease{ 0.5 };
+        float mGain{ 1000.f };
+        int mBlockSize{ 512 };
+        bool mIsWav{ true };
+        bool mIsLimited{ true };
+        ModalKernels::Isa mIsa{ ModalKernels::Isa::Scalar };
+        std::filesystem::path mOutputDir;
+    };
+
+    bool IsPosition(float aValue)
+    {
+        return aValue >= 0.f && aValue <= 1.f;
+    }
+
+    bool IsValid(const Job& aJob)
+    {
+        return aJob.mpPreset != nullptr && aJob.mSampleRate > 0.0 && aJob.mDuration > 0.0
+            && IsPosition(aJob.mInputPos) && IsPosition(aJob.mReadPos);
+    }
+
+    std::vector<Job> MakeSweep(const Tools::Arguments& aArgs, double aDuration)
+    {
+        std::vector<Job> vJobs;
+        std::vector<std::string> vStrings = aArgs.GetList("strings", "CelloA3,CelloD3,CelloG2,CelloC2");
+        for (auto& vString : vStrings)
+        {
+            for (double vRate : aArgs.GetDoubleList("sample-rates", "44100"))
+            {
+                for (double vPressure : aArgs.GetDoubleList("pressures", "10"))
+                {
+                    for (double vSpeed : aArgs.GetDoubleList("speeds", "0.2"))
+                    {
+                        for (double vInput : aArgs.GetDoubleList("inputs", "0.733"))
+                        {
+                            for (double vRead : aArgs.GetDoubleList("reads", "0.53"))
+                            {
+                                vJobs.push_back({ Tools::FindPreset(vString), vRate,
+                                    static_cast<float>(vPressure), static_cast<float>(vSpeed),
+                                    static_cast<float>(vInput), static_cast<float>(vRead), aDuration });
+                            }
+                        }
+                    }
+                }
+            }
+        }
+        return vJobs;
+    }
+
+    //Reads the jobs from a CSV file, printing the first error
+    bool ReadJobs(const std::string& aPath, double aDuration, std::vector<Job>& aJobs)
+    {
+        std::ifstream vFile(aPath);
+        if (!vFile)
+        {
+            std::cerr << "Cannot open " << aPath << std::endl;
+            return false;
+        }
+
+        std::string vLine;
+        int vLineNumber = 0;
+        while (std::getline(vFile, vLine))
+        {
+            ++vLineNumber;
+            if (!vLine.empty() && vLine.back() == '\r')
+            {
+                vLine.pop_back();
+            }
+            if (vLine.empty() || vLine[0] == '#' || vLine.rfind("string", 0) == 0)
+            {
+                continue;
+            }
+
+            std::vector<std::string> vFields;
+            std::stringstream vStream(vLine);
+            std::string vField;
+            while (std::getline(vStream, vField, ','))
+            {
+                vFields.push_back(vField);
+            }
+
+            Job vJob{ nullptr, 0.0, 0.f, 0.f, 0.f, 0.f, aDuration };
+            if (vFields.size() == 6 || vFields.size() == 7)
+            {
+                vJob.mpPreset = Tools::FindPreset(vFields[0]);
+                vJob.mSampleRate = std::atof(vFields[1].c_str());
+                vJob.mPressure = static_cast<float>(std::atof(vFields[2].c_str()));
+                vJob.mSpeed = static_cast<float>(std::atof(vFields[3].c_str()));
+                vJob.mInputPos = static_cast<float>(std::atof(vFields[4].c_str()));
+                vJob.mReadPos = static_cast<float>(std::atof(vFields[5].c_str()));
+                if (vFields.size() == 7)
+                {
+                    vJob.mDuration = std::atof(vFields[6].c_str());
+                }
+            }
+            if (!IsValid(vJob))
+            {
+                std::cerr << "Invalid job at line " << vLineNumber << std::endl;
+                return false;
+            }
+            aJobs.push_back(vJob);
+        }
+        return true;
+    }
+
+    std::string MakeFileName(const Job& aJob, std::size_t aIndex, bool aIsWav)
+    {
+        std::ostringstream vName;
+        vName << std::setw(6) << std::setfill('0') << aIndex << "_" << aJob.mpPreset->mpParams->mName
+            << "_" << static_cast<long long>(std::llround(aJob.mSampleRate)) << (aIsWav ? ".wav" : ".raw");
+        return vName.str();
+    }
+
+    //FNV-1a of the output bytes, to compare renders across runs
+    std::uint64_t Hash(const std::vector<unsigned char>& aBytes)
+    {
+        std::uint64_t vHash = 14695981039346656037ull;
+        for (unsigned char vByte : aBytes)
+        {
+            vHash = (vHash ^ vByte) * 1099511628211ull;
+        }
+        return vHash;
+    }
+
+    //Renders a job on the calling thread and writes its file
+    void RenderJob(const Job& aJob, const std::shared_ptr<const ModalStringTables>& apTables,
+        const RenderOptions& aOptions, JobResult& aResult)
+    {
+        auto vStart = std::chrono::steady_clock::now();
+
+        ModalStiffStringProcessor vProcessor(apTables);
+        vProcessor.SetKernelIsa(aOptions.mIsa);
+        vProcessor.SetInputPos(aJob.mInputPos);
+        vProcessor.SetReadPos(aJob.mReadPos);
+        vProcessor.SetBowSpeed(aJob.mSpeed);
+        vProcessor.SetBowPressure(aJob.mPressure);
+        vProcessor.SetGain(aOptions.mGain);
+        vProcessor.SetPlayState(true);
+
+        const std::uint64_t vBowedSamples = static_cast<std::uint64_t>(std::llround(aJob.mDuration * aJob.mSampleRate));
+        const std::uint64_t vTotalSamples = vBowedSamples + static_cast<std::uint64_t>(std::llround(aOptions.mRelease * aJob.mSampleRate));
+        const std::size_t vHeaderSize = aOptions.mIsWav ? Tools::kWavHeaderSize : 0;
+        std::vector<unsigned char> vBytes(vHeaderSize + 4 * vTotalSamples);
+        if (aOptions.mIsWav)
+        {
+            Tools::MakeWavHeader(vBytes.data(), static_cast<std::uint32_t>(aJob.mSampleRate), static_cast<std::uint32_t>(4 * vTotalSamples));
+        }
+
+        std::vector<float> vBlock(aOptions.mBlockSize);
+        std::uint64_t vSample = 0;
+        while (vSample < vTotalSamples)
+        {
+            //The release starts at its exact sample
+            std::uint64_t vBlockEnd = std::min<std::uint64_t>(vTotalSamples, vSample + aOptions.mBlockSize);
+            if (vSample < vBowedSamples)
+            {
+                vBlockEnd = std::min(vBlockEnd, vBowedSamples);
+            }
+            else
+            {
+                vProcessor.SetBowPressure(0.f);
+            }
+            const int vNumSamples = static_cast<int>(vBlockEnd - vSample);
+
+            vProcessor.ProcessBlock(vBlock.data(), vNumSamples);
+            for (int i = 0; i < vNumSamples; ++i)
+            {
+                float vValue = aOptions.mIsLimited ? Global::limitOutput(vBlock[i]) : vBlock[i];
+                Tools::StoreFloatLE(vBytes.data() + vHeaderSize + 4 * (vSample + i), vValue);
+            }
+            vSample = vBlockEnd;
+        }
+
+        aResult.mHash = Hash(vBytes);
+        std::ofstream vFile(aOptions.mOutputDir / aResult.mFileName, std::ios::binary);
+        vFile.write(reinterpret_cast<const char*>(vBytes.data()), static_cast<std::streamsize>(vBytes.size()));
+        aResult.mIsWritten = static_cast<bool>(vFile);
+        aResult.mSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - vStart).count();
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Tools::Arguments vArgs(argc, argv);
+    if (!vArgs.Has("output-dir"))
+    {
+        std::cerr << "Usage: FastBowedStringFarm --output-dir renders [--jobs jobs.csv] [--strings list]"
+            " [--sample-rates list] [--pressures list] [--speeds list] [--inputs list] [--reads list]"
+            " [--duration 2] [--release 0.5] [--gain 1000] [--block 512] [--threads N]"
+            " [--format wav|raw] [--isa name] [--no-limit] [--report report.json]" << std::endl;
+        return 1;
+    }
+
+    const double vDuration = vArgs.GetDouble("duration", 2.0);
+    std::vector<Job> vJobs;
+    if (vArgs.Has("jobs"))
+    {
+        if (!ReadJobs(vArgs.GetString("jobs", ""), vDuration, vJobs))
+        {
+            return 1;
+        }
+    }
+    else
+    {
+        vJobs = MakeSweep(vArgs, vDuration);
+        for (auto& vJob : vJobs)
+        {
+            if (!IsValid(vJob))
+            {
+                std::cerr << "Invalid sweep, check the string names, rates and positions" << std::endl;
+                return 1;
+            }
+        }
+    }
+    if (vJobs.empty())
+    {
+        std::cerr << "No jobs" << std::endl;
+        return 1;
+    }
+
+    RenderOptions vOptions;
+    vOptions.mRelease = std::max(0.0, vArgs.GetDouble("release", 0.5));
+    vOptions.mGain = static_cast<float>(vArgs.GetDouble("gain", 1000.0));
+    vOptions.mBlockSize = std::max(1, static_cast<int>(vArgs.GetDouble("block", 512)));
+    vOptions.mIsWav = vArgs.GetString("format", "wav") != "raw";
+    vOptions.mIsLimited = !vArgs.Has("no-limit");
+    vOptions.mOutputDir = vArgs.GetString("output-dir", "");
+    vOptions.mIsa = ModalKernels::GetBestSupportedIsa();
+    if (vArgs.Has("isa") && (!Tools::ParseIsa(vArgs.GetString("isa", ""), vOptions.mIsa) || !ModalKernels::IsSupported(vOptions.mIsa)))
+    {
+        std::cerr << "Unsupported instruction set " << vArgs.GetString("isa", "") << std::endl;
+        return 1;
+    }
+
+    std::error_code vError;
+    std::filesystem::create_directories(vOptions.mOutputDir, vError);
+    if (vError)
+    {
+        std::cerr << "Cannot create " << vOptions.mOutputDir.string() << std::endl;
+        return 1;
+    }
+
+    int vThreads = static_cast<int>(vArgs.GetDouble("threads", 0));
+    if (vThreads <= 0)
+    {
+        vThreads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+
+    auto vStart = std::chrono::steady_clock::now();
+
+    //One coefficient table set for each string and sample rate, built before
+    //the workers start and then only read
+    std::map<std::pair<int, double>, std::shared_ptr<const ModalStringTables>> vTables;
+    std::vector<const std::shared_ptr<const ModalStringTables>*> vJobTables;
+    for (auto& vJob : vJobs)
+    {
+        auto& vpTables = vTables[{ vJob.mpPreset->mpParams->mId, vJob.mSampleRate }];
+        if (!vpTables)
+        {
+            vpTables = ModalStringTables::Create(*vJob.mpPreset->mpString, vJob.mSampleRate);
+        }
+        vJobTables.push_back(&vpTables);
+    }
+
+    std::vector<JobResult> vResults(vJobs.size());
+    for (std::size_t i = 0; i < vJobs.size(); ++i)
+    {
+        vResults[i].mFileName = MakeFileName(vJobs[i], i, vOptions.mIsWav);
+    }
+
+    {
+        //The destructor of the pool returns once every scheduled job has run
+        Eigen::NonBlockingThreadPool vPool(vThreads);
+        for (std::size_t i = 0; i < vJobs.size(); ++i)
+        {
+            vPool.Schedule([&vJobs, &vJobTables, &vOptions, &vResults, i]()
+            {
+                RenderJob(vJobs[i], *vJobTables[i], vOptions, vResults[i]);
+            });
+        }
+    }
+
+    const double vWallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - vStart).count();
+
+    std::ofstream vManifest(vOptions.mOutputDir / "manifest.csv");
+    vManifest << "file,string,sample_rate,pressure,speed,input,read,duration,release,hash\n";
+    double vAudioSeconds = 0.0;
+    double vJobSeconds = 0.0;
+    int vFailures = 0;
+    for (std::size_t i = 0; i < vJobs.size(); ++i)
+    {
+        const Job& vJob = vJobs[i];
+        vManifest << vResults[i].mFileName << "," << vJob.mpPreset->mpParams->mName << "," << vJob.mSampleRate
+            << "," << vJob.mPressure << "," << vJob.mSpeed << "," << vJob.mInputPos << "," << vJob.mReadPos
+            << "," << vJob.mDuration << "," << vOptions.mRelease << ","
+            << std::hex << std::setw(16) << std::setfill('0') << vResults[i].mHash << std::dec << std::setfill(' ') << "\n";
+        vAudioSeconds += vJob.mDuration + vOptions.mRelease;
+        vJobSeconds += vResults[i].mSeconds;
+        if (!vResults[i].mIsWritten)
+        {
+            std::cerr << "Cannot write " << vResults[i].mFileName << std::endl;
+            ++vFailures;
+        }
+    }
+
+    std::ofstream vReportFile;
+    if (vArgs.Has("report"))
+    {
+        vReportFile.open(vArgs.GetString("report", ""));
+        if (!vReportFile)
+        {
+            std::cerr << "Cannot open " << vArgs.GetString("report", "") << std::endl;
+            return 1;
+        }
+    }
+    Tools::JsonWriter vJson(vReportFile.is_open() ? static_cast<std::ostream&>(vReportFile) : std::cout);
+
+    //Parallel efficiency is the busy time of the jobs over the time the threads were available
+    vJson.BeginObject();
+    vJson.Field("jobs", static_cast<int>(vJobs.size()));
+    vJson.Field("threads", vThreads);
+    vJson.Field("coefficient_tables", static_cast<int>(vTables.size()));
+    vJson.Field("isa", ModalKernels::GetIsaName(vOptions.mIsa));
+    vJson.Field("audio_seconds", vAudioSeconds);
+    vJson.Field("wall_seconds", vWallSeconds);
+    vJson.Field("job_seconds", vJobSeconds);
+    vJson.Field("real_time_factor", vAudioSeconds > 0.0 ? vWallSeconds / vAudioSeconds : 0.0);
+    vJson.Field("jobs_per_second", vWallSeconds > 0.0 ? vJobs.size() / vWallSeconds : 0.0);
+    vJson.Field("parallel_efficiency", vWallSeconds > 0.0 ? vJobSeconds / (vWallSeconds * vThreads) : 0.0);
+    vJson.Field("failures", vFailures);
+    vJson.EndObject();
+    return vFailures == 0 ? 0 : 1;
+}
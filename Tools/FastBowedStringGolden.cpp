@@ -0,0 +1,766 @@
+/*
+  ==============================================================================
+
+    FastBowedStringGolden.cpp
+    Created: 17/10/2026
+
+  ==============================================================================
+*/
+
+/*
+Golden output regression harness. Fixed scenarios, i.e. schedules of bow
+pressure, speed and position, are rendered for each preset with the reference
+engine and stored as goldens. Every engine variant is then rendered with the
+same scenarios and compared against them:
+
+    max_abs_db  peak of the error, in dB relative to the peak of the golden
+    rms_db      RMS of the error, in dB relative to the RMS of the golden
+    lsd_db      mean log spectral distance between the Hann windowed frames,
+                bins more than 100 dB below the frame peak of the golden are
+                clamped to that floor
+
+The reference is the dynamic modal engine with the scalar kernel, the exact
+friction and without sleeping, mode dropping, node culling or crossfade of
+the mode shapes. The variants that crossfade the mode shapes are compared
+against a reference with the crossfade on for the scenarios moving the bow,
+stored as <scenario>-crossfade goldens. The time domain
+schemes do not take the bow schedule, so their scenario runs with the
+built-in bow and is compared against calculateFirstOrderRef.
+
+The voice-pipeline check plays a fixed sequence of notes on a ModalVoicePool,
+once directly and once through a ModalVoicePipeline, and compares the
+pipelined output shifted back by GetLatencySamples() against the direct one.
+It also fails if the render thread missed any sample.
+
+Usage:
+    FastBowedStringGolden --record [--golden-dir Tools/Goldens]
+    FastBowedStringGolden [--golden-dir Tools/Goldens] [--variants modal-avx2,...]
+                          [--max-abs-db -50] [--rms-db -55] [--lsd-db 1]
+                          [--output report.json]
+
+The goldens are raw little endian float32 files named
+<scenario>_<preset>_<sample rate>.f32. The comparison returns 1 if any variant
+is out of tolerance, 2 if a golden is missing.
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <complex>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unsupported/Eigen/FFT>
+#include "ToolsCommon.h"
+#include "Bowed1DWaveFirstOrder.h"
+#include "ModalStiffStringProcessor.h"
+#include "ModalStringBatch.h"
+#include "ModalVoicePipeline.h"
+#include "StaticModalStiffString.h"
+
+#ifndef FASTBOWEDSTRING_GOLDEN_DIR
+#define FASTBOWEDSTRING_GOLDEN_DIR "Tools/Goldens"
+#endif
+
+namespace
+{
+    constexpr double kSampleRate = 44100.0;
+
+    //Bow parameters are updated at the boundaries of the control blocks
+    constexpr int kControlBlock = 64;
+
+    constexpr float kReadPos = 0.53f;
+    constexpr float kGain = 1000.f;
+    constexpr float kTimeDomainReadPos = 0.8f;
+
+    constexpr int kSpectrumFrame = 2048;
+    constexpr double kSpectrumFloorDb = -100.0;
+
+    const char* const kTimeDomainPreset = "TimeDomain";
+    const char* const kTimeDomainScenario = "builtin-bow";
+
+    struct Keyframe
+    {
+        double mTime;
+        float mPressure;
+        float mSpeed;
+        float mInputPos;
+    };
+
+    //Bow parameters are linearly interpolated between the keyframes
+    struct Scenario
+    {
+        const char* mName;
+        double mSeconds;
+        std::vector<Keyframe> mKeyframes;
+        bool mIsMoving{ false };        //True if the bow position changes
+    };
+
+    const std::vector<Scenario>& GetScenarios()
+    {
+        static const std::vector<Scenario> sScenarios = {
+            { "sustain", 0.5, { { 0.0, 10.f, 0.2f, 0.733f } } },
+            //Attack, hold and release into the free decay
+            { "attack-release", 0.5, { { 0.0, 0.f, 0.2f, 0.733f }, { 0.05, 10.f, 0.2f, 0.733f },
+                                       { 0.25, 10.f, 0.2f, 0.733f }, { 0.2501, 0.f, 0.2f, 0.733f } } },
+            { "position-sweep", 0.5, { { 0.0, 8.f, 0.1f, 0.6f }, { 0.5, 8.f, 0.3f, 0.85f } }, true },
+            //Above about 15 the C2 and G2 strings turn chaotic and no variant
+            //follows the golden sample by sample
+            { "pressure-swell", 0.5, { { 0.0, 2.f, 0.15f, 0.733f }, { 0.5, 15.f, 0.15f, 0.733f } } } };
+        return sScenarios;
+    }
+
+    Keyframe Interpolate(const Scenario& aScenario, double aTime)
+    {
+        auto& vKeys = aScenario.mKeyframes;
+        if (aTime <= vKeys.front().mTime)
+        {
+            return vKeys.front();
+        }
+        for (size_t i = 1; i < vKeys.size(); ++i)
+        {
+            if (aTime < vKeys[i].mTime)
+            {
+                float vAlpha = static_cast<float>((aTime - vKeys[i - 1].mTime) / (vKeys[i].mTime - vKeys[i - 1].mTime));
+                auto Lerp = [vAlpha](float aFrom, float aTo) { return aFrom + vAlpha * (aTo - aFrom); };
+                return { aTime,
+                    Lerp(vKeys[i - 1].mPressure, vKeys[i].mPressure),
+                    Lerp(vKeys[i - 1].mSpeed, vKeys[i].mSpeed),
+                    Lerp(vKeys[i - 1].mInputPos, vKeys[i].mInputPos) };
+            }
+        }
+        return vKeys.back();
+    }
+
+    std::vector<float> RenderScenario(ModalStringEngine& aEngine, const Scenario& aScenario, double aSampleRate)
+    {
+        std::vector<float> vOutput(static_cast<size_t>(aScenario.mSeconds * aSampleRate));
+        aEngine.SetReadPos(kReadPos);
+        aEngine.SetGain(kGain);
+        aEngine.SetPlayState(true);
+
+        float vInputPos = -1.f;
+        for (size_t vStart = 0; vStart < vOutput.size(); vStart += kControlBlock)
+        {
+            Keyframe vKey = Interpolate(aScenario, vStart / aSampleRate);
+            aEngine.SetBowPressure(vKey.mPressure);
+            aEngine.SetBowSpeed(vKey.mSpeed);
+            //The input modes are recomputed only when the position moves
+            if (vKey.mInputPos != vInputPos)
+            {
+                vInputPos = vKey.mInputPos;
+                aEngine.SetInputPos(vInputPos);
+            }
+            int vNumSamples = static_cast<int>(std::min<size_t>(kControlBlock, vOutput.size() - vStart));
+            aEngine.ProcessBlock(vOutput.data() + vStart, vNumSamples);
+        }
+        return vOutput;
+    }
+
+    //Note played at the start of a block of the voice-pipeline check, a zero
+    //velocity is a note off
+    struct NoteEvent
+    {
+        int mBlock;
+        int mNote;
+        float mVelocity;
+    };
+
+    const char* const kVoicesVariant = "voice-pipeline";
+    const char* const kVoicesScenario = "notes";
+    const char* const kVoicesPreset = "Voices";
+    constexpr int kVoicesBlock = 128;
+    constexpr int kVoicesBlocksNumber = 200;
+
+    const std::vector<NoteEvent>& GetNoteEvents()
+    {
+        //Overlapping notes, a repeated one and a chord released at once
+        static const std::vector<NoteEvent> sEvents = {
+            { 0, 45, 0.8f }, { 10, 52, 0.5f }, { 30, 45, 0.f }, { 40, 45, 1.f },
+            { 60, 36, 0.6f }, { 60, 43, 0.6f }, { 60, 50, 0.6f }, { 90, 52, 0.f },
+            { 120, 36, 0.f }, { 120, 43, 0.f }, { 120, 50, 0.f }, { 150, 45, 0.f } };
+        return sEvents;
+    }
+
+    /*
+    Renders the note events on a ModalVoicePool, directly or through a
+    ModalVoicePipeline. The pipelined output is shifted back by its latency,
+    so that both are the same, and waits for the render thread before each
+    read so that no sample is missed. aUnderrunSamples is set to the samples
+    the pipeline did not render in time.
+    */
+    std::vector<float> RenderNotes(bool aIsPipelined, long long& aUnderrunSamples)
+    {
+        ModalVoicePool vPool;
+        ModalVoicePipeline vPipeline(vPool);
+        if (aIsPipelined)
+        {
+            vPipeline.Prepare(kSampleRate, kVoicesBlock);
+        }
+        else
+        {
+            vPool.Prepare(kSampleRate);
+        }
+
+        //One more block to read the last one through the pipeline
+        std::vector<float> vOutput(static_cast<size_t>(kVoicesBlocksNumber + 1) * kVoicesBlock, 0.f);
+        for (int b = 0; b <= kVoicesBlocksNumber; ++b)
+        {
+            for (auto& vEvent : GetNoteEvents())
+            {
+                if (vEvent.mBlock != b)
+                {
+                    continue;
+                }
+                if (aIsPipelined)
+                {
+                    vEvent.mVelocity > 0.f ? vPipeline.NoteOn(vEvent.mNote, vEvent.mVelocity) : vPipeline.NoteOff(vEvent.mNote);
+                }
+                else
+                {
+                    vEvent.mVelocity > 0.f ? vPool.NoteOn(vEvent.mNote, vEvent.mVelocity) : vPool.NoteOff(vEvent.mNote);
+                }
+            }
+
+            float* vpBlock = vOutput.data() + static_cast<size_t>(b) * kVoicesBlock;
+            if (aIsPipelined)
+            {
+                vPipeline.Render(kVoicesBlock);
+                while (vPipeline.GetReadySamplesNumber() < static_cast<size_t>(kVoicesBlock))
+                {
+                    std::this_thread::yield();
+                }
+                vPipeline.Read(vpBlock, kVoicesBlock);
+            }
+            else
+            {
+                vPool.ProcessBlock(vpBlock, kVoicesBlock);
+            }
+        }
+
+        aUnderrunSamples = aIsPipelined ? vPipeline.GetUnderrunSamplesNumber() : 0;
+        if (aIsPipelined)
+        {
+            vOutput.erase(vOutput.begin(), vOutput.begin() + vPipeline.GetLatencySamples());
+        }
+        vOutput.resize(static_cast<size_t>(kVoicesBlocksNumber) * kVoicesBlock);
+        return vOutput;
+    }
+
+    enum class TimeDomainScheme
+    {
+        Ref,
+        Opt,
+        OptVec
+    };
+
+    std::vector<float> RenderTimeDomain(TimeDomainScheme aScheme, double aSeconds, double aSampleRate)
+    {
+        Bowed1DWaveFirstOrder vString(1.0 / aSampleRate);
+        const int vReadIndex = vString.getNumGridPoints() + static_cast<int>(std::floor(kTimeDomainReadPos * vString.getNumGridPoints()));
+        std::vector<float> vOutput(static_cast<size_t>(aSeconds * aSampleRate));
+        for (auto& vSample : vOutput)
+        {
+            switch (aScheme)
+            {
+            case TimeDomainScheme::Ref:
+                vString.calculateFirstOrderRef();
+                vSample = static_cast<float>(vString.getRefState()[vReadIndex]);
+                break;
+            case TimeDomainScheme::Opt:
+                vString.calculateFirstOrderOpt();
+                vSample = static_cast<float>(vString.getOptState()[vReadIndex]);
+                break;
+            case TimeDomainScheme::OptVec:
+                vString.calculateFirstOrderOptVec();
+                vSample = vString.getOutput(kTimeDomainReadPos);
+                break;
+            }
+        }
+        return vOutput;
+    }
+
+    //Dynamic modal engine with every approximation disabled, the golden reference
+    std::unique_ptr<ModalStiffStringProcessor> MakeExactModal(ModalKernels::Isa aIsa, Global::Strings::String* apString,
+        bool aCrossfadesModes = false)
+    {
+        auto vpProcessor = std::make_unique<ModalStiffStringProcessor>(kSampleRate, apString);
+        vpProcessor->SetKernelIsa(aIsa);
+        vpProcessor->SetSleepEnergyFloor(0.f);
+        vpProcessor->SetModeEnergyThreshold(0.f);
+        vpProcessor->SetNodeWeightThreshold(0.f);
+        vpProcessor->SetModesCrossfade(aCrossfadesModes);
+        return vpProcessor;
+    }
+
+    /*
+    The string under test rendered by a ModalStringBatch, next to one string of
+    each preset that plays the same schedule, so that lanes of other modes
+    numbers and the zero padding share its group.
+    */
+    class BatchEngine : public ModalStringEngine
+    {
+    public:
+        explicit BatchEngine(Global::Strings::String* apString)
+            : mBatch(MakeTables(apString))
+        {
+            mOutputs.resize(mBatch.GetStringsNumber());
+        }
+
+        void SetPlayState(bool) override {}
+        void ResetStringStates() override { ForEach([this](int s) { mBatch.ResetStringStates(s); }); }
+        void SetInputPos(float aNewPos) override { ForEach([&](int s) { mBatch.SetInputPos(s, aNewPos); }); }
+        void SetReadPos(float aNewPos) override { ForEach([&](int s) { mBatch.SetReadPos(s, aNewPos); }); }
+        void SetGain(float aGain) override { ForEach([&](int s) { mBatch.SetGain(s, aGain); }); }
+        void SetBowPressure(float aPressure) override { ForEach([&](int s) { mBatch.SetBowPressure(s, aPressure); }); }
+        void SetBowSpeed(float aSpeed) override { ForEach([&](int s) { mBatch.SetBowSpeed(s, aSpeed); }); }
+        void SetSleepEnergyFloor(float) override {}
+
+        bool ProcessBlock(float* apOutput, int aNumSamples) override
+        {
+            std::vector<float*> vpOutputs(mOutputs.size());
+            vpOutputs[0] = apOutput;
+            for (size_t s = 1; s < mOutputs.size(); ++s)
+            {
+                mOutputs[s].resize(aNumSamples);
+                vpOutputs[s] = mOutputs[s].data();
+            }
+            mBatch.ProcessBlock(vpOutputs.data(), aNumSamples);
+            return true;
+        }
+
+        int GetModesNumber() override { return mBatch.GetPaddedModesNumber(); }
+
+    private:
+        ModalStringBatch mBatch;
+        std::vector<std::vector<float>> mOutputs;
+
+        static std::vector<std::shared_ptr<const ModalStringTables>> MakeTables(Global::Strings::String* apString)
+        {
+            std::vector<std::shared_ptr<const ModalStringTables>> vTables{ ModalStringTables::Create(*apString, kSampleRate) };
+            for (auto& vPreset : Tools::GetPresets())
+            {
+                vTables.push_back(ModalStringTables::Create(*vPreset.mpString, kSampleRate));
+            }
+            return vTables;
+        }
+
+        template <class F>
+        void ForEach(F aFunction)
+        {
+            for (int s = 0; s < mBatch.GetStringsNumber(); ++s)
+            {
+                aFunction(s);
+            }
+        }
+    };
+
+    /*
+    The string under test read by kMaxPickups pickups at once, the first one
+    at the read position of the schedule and the others spread along the
+    string. Only the first pickup is compared with the golden.
+    */
+    class PickupsEngine : public ModalStringEngine
+    {
+    public:
+        explicit PickupsEngine(std::unique_ptr<ModalStiffStringProcessor> apProcessor)
+            : mpProcessor(std::move(apProcessor))
+        {
+            mpProcessor->SetPickupsNumber(kPickupsNumber);
+            for (int k = 1; k < kPickupsNumber; ++k)
+            {
+                mpProcessor->SetPickupPos(k, static_cast<float>(k) / kPickupsNumber);
+            }
+            mOutputs.resize(kPickupsNumber);
+        }
+
+        void SetPlayState(bool aPlayState) override { mpProcessor->SetPlayState(aPlayState); }
+        void ResetStringStates() override { mpProcessor->ResetStringStates(); }
+        void SetInputPos(float aNewPos) override { mpProcessor->SetInputPos(aNewPos); }
+        void SetReadPos(float aNewPos) override { mpProcessor->SetReadPos(aNewPos); }
+        void SetGain(float aGain) override { mpProcessor->SetGain(aGain); }
+        void SetBowPressure(float aPressure) override { mpProcessor->SetBowPressure(aPressure); }
+        void SetBowSpeed(float aSpeed) override { mpProcessor->SetBowSpeed(aSpeed); }
+        void SetSleepEnergyFloor(float aEnergyFloor) override { mpProcessor->SetSleepEnergyFloor(aEnergyFloor); }
+
+        bool ProcessBlock(float* apOutput, int aNumSamples) override
+        {
+            float* vpOutputs[kPickupsNumber] = { apOutput };
+            for (int k = 1; k < kPickupsNumber; ++k)
+            {
+                mOutputs[k].resize(aNumSamples);
+                vpOutputs[k] = mOutputs[k].data();
+            }
+            return mpProcessor->ProcessBlock(vpOutputs, kPickupsNumber, aNumSamples);
+        }
+
+        int GetModesNumber() override { return mpProcessor->GetModesNumber(); }
+
+    private:
+        static constexpr int kPickupsNumber = ModalStiffStringProcessor::kMaxPickups;
+
+        std::unique_ptr<ModalStiffStringProcessor> mpProcessor;
+        std::vector<std::vector<float>> mOutputs;
+    };
+
+    /*
+    Engine variant under test. Modal variants render every scenario of every
+    preset, the time domain ones render the built-in bow only.
+    */
+    struct Variant
+    {
+        std::string mName;
+        std::function<std::unique_ptr<ModalStringEngine>(Global::Strings::String*)> mMakeModal;
+        TimeDomainScheme mTimeDomainScheme;
+        bool mCrossfadesModes{ false };
+    };
+
+    std::vector<Variant> GetVariants()
+    {
+        using ModalKernels::Isa;
+        std::vector<Variant> vVariants;
+        for (auto vIsa : { Isa::Scalar, Isa::Sse2, Isa::Avx2, Isa::Avx512 })
+        {
+            if (!ModalKernels::IsSupported(vIsa))
+            {
+                continue;
+            }
+            std::string vName = "modal-exact-" + Tools::GetIsaKey(vIsa);
+            vVariants.push_back({ vName, [vIsa](Global::Strings::String* apString) { return MakeExactModal(vIsa, apString); }, TimeDomainScheme::Ref });
+        }
+
+        //Crossfade of the mode shapes with the best kernel, exact otherwise
+        vVariants.push_back({ "modal-crossfade", [](Global::Strings::String* apString)
+            {
+                return MakeExactModal(ModalKernels::GetBestSupportedIsa(), apString, true);
+            }, TimeDomainScheme::Ref, true });
+
+        //Default settings, with sleeping, mode dropping, node culling and crossfade
+        vVariants.push_back({ "modal-default", [](Global::Strings::String* apString)
+            {
+                return std::unique_ptr<ModalStringEngine>(std::make_unique<ModalStiffStringProcessor>(kSampleRate, apString));
+            }, TimeDomainScheme::Ref, true });
+
+        //Approximated friction, exact otherwise
+        for (auto vAccuracy : { BowFriction::Accuracy::Polynomial, BowFriction::Accuracy::Table })
+        {
+            std::string vName = std::string("modal-friction-") + (vAccuracy == BowFriction::Accuracy::Table ? "table" : "polynomial");
+            vVariants.push_back({ vName, [vAccuracy](Global::Strings::String* apString)
+                {
+                    auto vpProcessor = MakeExactModal(ModalKernels::GetBestSupportedIsa(), apString);
+                    vpProcessor->SetFrictionAccuracy(vAccuracy);
+                    return vpProcessor;
+                }, TimeDomainScheme::Ref });
+        }
+
+        //Pickups read together with the first one, exact otherwise
+        vVariants.push_back({ "modal-pickups", [](Global::Strings::String* apString)
+            {
+                return std::unique_ptr<ModalStringEngine>(
+                    std::make_unique<PickupsEngine>(MakeExactModal(ModalKernels::GetBestSupportedIsa(), apString)));
+            }, TimeDomainScheme::Ref });
+
+        //Batch of strings interleaved over the SIMD lanes, exact friction
+        vVariants.push_back({ "modal-batch", [](Global::Strings::String* apString)
+            {
+                return std::unique_ptr<ModalStringEngine>(std::make_unique<BatchEngine>(apString));
+            }, TimeDomainScheme::Ref });
+
+        vVariants.push_back({ "modal-static", [](Global::Strings::String* apString)
+            {
+                return CreateStaticModalStiffString(*apString, kSampleRate);
+            }, TimeDomainScheme::Ref });
+
+        vVariants.push_back({ "time-domain-opt", nullptr, TimeDomainScheme::Opt });
+        vVariants.push_back({ "time-domain-optvec", nullptr, TimeDomainScheme::OptVec });
+        return vVariants;
+    }
+
+    //Name of the golden of aScenario for a variant that crossfades the mode shapes or not
+    std::string GetGoldenScenario(const Scenario& aScenario, bool aCrossfadesModes)
+    {
+        return std::string(aScenario.mName) + (aCrossfadesModes && aScenario.mIsMoving ? "-crossfade" : "");
+    }
+
+    std::string GetGoldenPath(const std::string& aDir, const std::string& aScenario, const std::string& aPreset)
+    {
+        return aDir + "/" + aScenario + "_" + aPreset + "_" + std::to_string(static_cast<int>(kSampleRate)) + ".f32";
+    }
+
+    //Raw float32, written in little endian whatever the host
+    bool WriteGolden(const std::string& aPath, const std::vector<float>& aSamples)
+    {
+        std::ofstream vFile(aPath, std::ios::binary);
+        unsigned char vBytes[4];
+        for (float vSample : aSamples)
+        {
+            Tools::StoreFloatLE(vBytes, vSample);
+            vFile.write(reinterpret_cast<const char*>(vBytes), 4);
+        }
+        return static_cast<bool>(vFile);
+    }
+
+    bool ReadGolden(const std::string& aPath, std::vector<float>& aSamples)
+    {
+        std::ifstream vFile(aPath, std::ios::binary);
+        if (!vFile)
+        {
+            return false;
+        }
+        aSamples.clear();
+        unsigned char vBytes[4];
+        while (vFile.read(reinterpret_cast<char*>(vBytes), 4))
+        {
+            aSamples.push_back(Tools::LoadFloatLE(vBytes));
+        }
+        return true;
+    }
+
+    struct Metrics
+    {
+        double mMaxAbsDb;
+        double mRmsDb;
+        double mLsdDb;
+    };
+
+    double ToDb(double aRatio)
+    {
+        return 20.0 * std::log10(std::max(aRatio, 1e-30));
+    }
+
+    //Magnitude spectrum in dB of the Hann windowed frame starting at aStart
+    std::vector<double> FrameSpectrumDb(Eigen::FFT<double>& aFft, const std::vector<float>& aSignal, size_t aStart)
+    {
+        std::vector<double> vFrame(kSpectrumFrame);
+        for (int i = 0; i < kSpectrumFrame; ++i)
+        {
+            double vWindow = 0.5 - 0.5 * std::cos(2.0 * Global::kPi * i / kSpectrumFrame);
+            vFrame[i] = vWindow * aSignal[aStart + i];
+        }
+        std::vector<std::complex<double>> vSpectrum;
+        aFft.fwd(vSpectrum, vFrame);
+
+        std::vector<double> vDb(kSpectrumFrame / 2 + 1);
+        for (size_t k = 0; k < vDb.size(); ++k)
+        {
+            vDb[k] = ToDb(std::abs(vSpectrum[k]));
+        }
+        return vDb;
+    }
+
+    Metrics Compare(const std::vector<float>& aGolden, const std::vector<float>& aTest)
+    {
+        double vPeak = 0.0, vMaxError = 0.0, vEnergy = 0.0, vErrorEnergy = 0.0;
+        for (size_t n = 0; n < aGolden.size(); ++n)
+        {
+            double vError = static_cast<double>(aTest[n]) - aGolden[n];
+            vPeak = std::max(vPeak, std::abs(static_cast<double>(aGolden[n])));
+            vMaxError = std::max(vMaxError, std::abs(vError));
+            vEnergy += static_cast<double>(aGolden[n]) * aGolden[n];
+            vErrorEnergy += vError * vError;
+        }
+
+        Metrics vMetrics;
+        //A silent golden is matched only by a silent output
+        vMetrics.mMaxAbsDb = vPeak > 0.0 ? ToDb(vMaxError / vPeak) : (vMaxError > 0.0 ? HUGE_VAL : -HUGE_VAL);
+        vMetrics.mRmsDb = vEnergy > 0.0 ? 10.0 * std::log10(std::max(vErrorEnergy / vEnergy, 1e-30)) : vMetrics.mMaxAbsDb;
+
+        //Half overlapping frames
+        Eigen::FFT<double> vFft;
+        double vDistance = 0.0;
+        int vFramesNumber = 0;
+        for (size_t vStart = 0; vStart + kSpectrumFrame <= aGolden.size(); vStart += kSpectrumFrame / 2)
+        {
+            auto vGoldenDb = FrameSpectrumDb(vFft, aGolden, vStart);
+            auto vTestDb = FrameSpectrumDb(vFft, aTest, vStart);
+            double vFloor = *std::max_element(vGoldenDb.begin(), vGoldenDb.end()) + kSpectrumFloorDb;
+            double vSquares = 0.0;
+            for (size_t k = 0; k < vGoldenDb.size(); ++k)
+            {
+                double vDiff = std::max(vTestDb[k], vFloor) - std::max(vGoldenDb[k], vFloor);
+                vSquares += vDiff * vDiff;
+            }
+            vDistance += std::sqrt(vSquares / vGoldenDb.size());
+            ++vFramesNumber;
+        }
+        vMetrics.mLsdDb = vFramesNumber > 0 ? vDistance / vFramesNumber : 0.0;
+        return vMetrics;
+    }
+
+    struct Tolerances
+    {
+        double mMaxAbsDb;
+        double mRmsDb;
+        double mLsdDb;
+    };
+
+    int Record(const std::string& aDir)
+    {
+        for (auto& vPreset : Tools::GetPresets())
+        {
+            for (auto& vScenario : GetScenarios())
+            {
+                for (bool vCrossfadesModes : { false, true })
+                {
+                    if (vCrossfadesModes && !vScenario.mIsMoving)
+                    {
+                        continue;
+                    }
+                    auto vpEngine = MakeExactModal(ModalKernels::Isa::Scalar, vPreset.mpString, vCrossfadesModes);
+                    std::string vPath = GetGoldenPath(aDir, GetGoldenScenario(vScenario, vCrossfadesModes), vPreset.mpParams->mName);
+                    if (!WriteGolden(vPath, RenderScenario(*vpEngine, vScenario, kSampleRate)))
+                    {
+                        std::cerr << "Cannot write " << vPath << std::endl;
+                        return 1;
+                    }
+                }
+            }
+        }
+
+        std::string vPath = GetGoldenPath(aDir, kTimeDomainScenario, kTimeDomainPreset);
+        if (!WriteGolden(vPath, RenderTimeDomain(TimeDomainScheme::Ref, GetScenarios().front().mSeconds, kSampleRate)))
+        {
+            std::cerr << "Cannot write " << vPath << std::endl;
+            return 1;
+        }
+        return 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Tools::Arguments vArgs(argc, argv);
+    std::string vDir = vArgs.GetString("golden-dir", FASTBOWEDSTRING_GOLDEN_DIR);
+
+    if (vArgs.Has("record"))
+    {
+        return Record(vDir);
+    }
+
+    Tolerances vTolerances{ vArgs.GetDouble("max-abs-db", -50.0), vArgs.GetDouble("rms-db", -55.0), vArgs.GetDouble("lsd-db", 1.0) };
+    std::vector<std::string> vSelected = vArgs.GetList("variants", "");
+
+    std::ofstream vFile;
+    if (vArgs.Has("output"))
+    {
+        vFile.open(vArgs.GetString("output", ""));
+        if (!vFile)
+        {
+            std::cerr << "Cannot open " << vArgs.GetString("output", "") << std::endl;
+            return 1;
+        }
+    }
+    Tools::JsonWriter vJson(vFile.is_open() ? static_cast<std::ostream&>(vFile) : std::cout);
+
+    vJson.BeginObject();
+    vJson.Field("sample_rate", kSampleRate);
+    vJson.Key("tolerances");
+    vJson.BeginObject();
+    vJson.Field("max_abs_db", vTolerances.mMaxAbsDb);
+    vJson.Field("rms_db", vTolerances.mRmsDb);
+    vJson.Field("lsd_db", vTolerances.mLsdDb);
+    vJson.EndObject();
+    vJson.Key("results");
+    vJson.BeginArray();
+
+    int vFailures = 0;
+    bool vIsGoldenMissing = false;
+    auto CheckAndWrite = [&](const std::string& aVariant, const std::string& aScenario, const std::string& aPreset,
+        const std::vector<float>& aOutput)
+    {
+        std::vector<float> vGolden;
+        std::string vPath = GetGoldenPath(vDir, aScenario, aPreset);
+        vJson.BeginObject();
+        vJson.Field("variant", aVariant);
+        vJson.Field("scenario", aScenario);
+        vJson.Field("preset", aPreset);
+        if (!ReadGolden(vPath, vGolden) || vGolden.size() != aOutput.size())
+        {
+            std::cerr << "Missing or mismatched golden " << vPath << std::endl;
+            vIsGoldenMissing = true;
+            vJson.Field("error", "missing golden");
+            vJson.EndObject();
+            return;
+        }
+
+        Metrics vMetrics = Compare(vGolden, aOutput);
+        bool vIsPassing = vMetrics.mMaxAbsDb <= vTolerances.mMaxAbsDb
+            && vMetrics.mRmsDb <= vTolerances.mRmsDb
+            && vMetrics.mLsdDb <= vTolerances.mLsdDb;
+        vFailures += vIsPassing ? 0 : 1;
+
+        vJson.Field("max_abs_db", vMetrics.mMaxAbsDb);
+        vJson.Field("rms_db", vMetrics.mRmsDb);
+        vJson.Field("lsd_db", vMetrics.mLsdDb);
+        vJson.Field("pass", vIsPassing);
+        vJson.EndObject();
+    };
+
+    for (auto& vVariant : GetVariants())
+    {
+        if (!vSelected.empty() && std::find(vSelected.begin(), vSelected.end(), vVariant.mName) == vSelected.end())
+        {
+            continue;
+        }
+
+        if (!vVariant.mMakeModal)
+        {
+            CheckAndWrite(vVariant.mName, kTimeDomainScenario, kTimeDomainPreset,
+                RenderTimeDomain(vVariant.mTimeDomainScheme, GetScenarios().front().mSeconds, kSampleRate));
+            continue;
+        }
+
+        for (auto& vPreset : Tools::GetPresets())
+        {
+            for (auto& vScenario : GetScenarios())
+            {
+                auto vpEngine = vVariant.mMakeModal(vPreset.mpString);
+                //Variants may not exist for every preset, e.g. modal-static
+                if (!vpEngine)
+                {
+                    continue;
+                }
+                CheckAndWrite(vVariant.mName, GetGoldenScenario(vScenario, vVariant.mCrossfadesModes), vPreset.mpParams->mName,
+                    RenderScenario(*vpEngine, vScenario, kSampleRate));
+            }
+        }
+    }
+
+    if (vSelected.empty() || std::find(vSelected.begin(), vSelected.end(), kVoicesVariant) != vSelected.end())
+    {
+        long long vUnderrunSamples = 0;
+        std::vector<float> vDirect = RenderNotes(false, vUnderrunSamples);
+        std::vector<float> vPipelined = RenderNotes(true, vUnderrunSamples);
+
+        Metrics vMetrics = Compare(vDirect, vPipelined);
+        bool vIsPassing = vUnderrunSamples == 0
+            && vMetrics.mMaxAbsDb <= vTolerances.mMaxAbsDb
+            && vMetrics.mRmsDb <= vTolerances.mRmsDb
+            && vMetrics.mLsdDb <= vTolerances.mLsdDb;
+        vFailures += vIsPassing ? 0 : 1;
+
+        vJson.BeginObject();
+        vJson.Field("variant", kVoicesVariant);
+        vJson.Field("scenario", kVoicesScenario);
+        vJson.Field("preset", kVoicesPreset);
+        vJson.Field("max_abs_db", vMetrics.mMaxAbsDb);
+        vJson.Field("rms_db", vMetrics.mRmsDb);
+        vJson.Field("lsd_db", vMetrics.mLsdDb);
+        vJson.Field("underrun_samples", vUnderrunSamples);
+        vJson.Field("pass", vIsPassing);
+        vJson.EndObject();
+    }
+
+    vJson.EndArray();
+    vJson.Field("failures", vFailures);
+    vJson.EndObject();
+
+    if (vIsGoldenMissing)
+    {
+        return 2;
+    }
+    return vFailures > 0 ? 1 : 0;
+}
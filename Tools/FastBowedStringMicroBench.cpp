@@ -0,0 +1,332 @@
+/*
+  ==============================================================================
+
+    FastBowedStringMicroBench.cpp
+    Created: 17/10/2026
+
+  ==============================================================================
+*/
+
+/*
+Isolated timings of the hot functions, to check that each stage scales
+linearly with the modes number and to catch regressions of a single stage.
+Every function is timed in two variants:
+
+    warm    back to back calls, the tables and states stay in cache
+    cold    a single call after evicting the caches, as for a parameter
+            change coming after the rest of the plugin has run
+
+The modal functions run for each preset and for synthetic strings with the
+requested modes number, built by lowering the tension of the C2 string until
+that many modes fall below 20 kHz.
+
+Usage:
+    FastBowedStringMicroBench [--modes 1000,2000,5000] [--trials 31]
+                              [--sample-rate 44100] [--filter SetInputPos]
+                              [--output results.json]
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include <BenchTimer.h>
+#include "ToolsCommon.h"
+#include "Global.h"
+#include "BowFriction.h"
+#include "ModalStiffStringProcessor.h"
+#include "PA_LowPass2.h"
+
+namespace
+{
+#if defined(_WIN32) || defined(__CYGWIN__)
+    constexpr int kTimer = Eigen::CPU_TIMER;
+#else
+    constexpr int kTimer = Eigen::REAL_TIMER;
+#endif
+
+    //Minimum duration of a warm batch, so that the timer resolution is negligible
+    constexpr double kMinBatchSeconds = 50e-6;
+
+    //Larger than the last level cache of the usual desktop CPUs
+    constexpr size_t kEvictionBytes = 64 * 1024 * 1024;
+
+    //Grid size used by the interpolation benchmarks
+    constexpr int kGridPoints = 1024;
+
+    //Contacts evaluated at once by the batched friction benchmarks, e.g. voices
+    constexpr int kFrictionBatch = 64;
+
+    struct Options
+    {
+        int mTrials;
+        std::string mFilter;
+    };
+
+    //Touches every cache line of a buffer larger than the caches
+    void EvictCaches()
+    {
+        static std::vector<char> sBuffer(kEvictionBytes);
+        for (size_t i = 0; i < sBuffer.size(); i += 64)
+        {
+            ++sBuffer[i];
+        }
+        escape(sBuffer.data());
+    }
+
+    double Median(std::vector<double> aValues)
+    {
+        std::sort(aValues.begin(), aValues.end());
+        return aValues[aValues.size() / 2];
+    }
+
+    /*
+    Times aCall in both variants and writes one result for each. aModes is the
+    size the cost is expected to scale with, zero if it does not apply.
+    */
+    template <class Call>
+    void Measure(Tools::JsonWriter& aJson, const Options& aOptions, const std::string& aName,
+        const std::string& aString, int aModes, Call&& aCall)
+    {
+        if (!aOptions.mFilter.empty() && aName.find(aOptions.mFilter) == std::string::npos)
+        {
+            return;
+        }
+
+        Eigen::BenchTimer vTimer;
+
+        //Batch size of the warm variant, doubled until the batch is long enough
+        int vBatch = 1;
+        while (true)
+        {
+            vTimer.start();
+            for (int i = 0; i < vBatch; ++i)
+            {
+                aCall();
+            }
+            vTimer.stop();
+            if (vTimer.value(kTimer) >= kMinBatchSeconds || vBatch >= (1 << 24))
+            {
+                break;
+            }
+            vBatch *= 2;
+        }
+
+        std::vector<double> vWarm;
+        for (int t = 0; t < aOptions.mTrials; ++t)
+        {
+            vTimer.start();
+            for (int i = 0; i < vBatch; ++i)
+            {
+                aCall();
+            }
+            vTimer.stop();
+            vWarm.push_back(vTimer.value(kTimer) / vBatch);
+        }
+
+        std::vector<double> vCold;
+        for (int t = 0; t < aOptions.mTrials; ++t)
+        {
+            EvictCaches();
+            vTimer.start();
+            aCall();
+            vTimer.stop();
+            vCold.push_back(vTimer.value(kTimer));
+        }
+
+        const std::pair<const char*, std::vector<double>*> kVariants[] = { { "warm", &vWarm }, { "cold", &vCold } };
+        for (auto& vVariant : kVariants)
+        {
+            double vMedian = Median(*vVariant.second);
+            aJson.BeginObject();
+            aJson.Field("function", aName);
+            aJson.Field("string", aString);
+            aJson.Field("modes", aModes);
+            aJson.Field("variant", vVariant.first);
+            aJson.Field("trials", aOptions.mTrials);
+            aJson.Field("calls_per_trial", vVariant.second == &vWarm ? vBatch : 1);
+            aJson.Field("ns_per_call", 1e9 * vMedian);
+            aJson.Field("ns_per_call_min", 1e9 * *std::min_element(vVariant.second->begin(), vVariant.second->end()));
+            aJson.Field("ns_per_mode", aModes > 0 ? 1e9 * vMedian / aModes : 0.0);
+            aJson.EndObject();
+        }
+    }
+
+    //String with C2 radius, density and length and the tension that gives aModesNumber modes
+    Global::Strings::String MakeSyntheticString(int aModesNumber)
+    {
+        using namespace Global::Strings;
+        String vString(kCelloC2Params);
+        vString.mId = 0;
+        vString.mName = "Synthetic" + std::to_string(aModesNumber);
+
+        //The modes below 20 kHz are n < 2 L f / c, aim between two modes
+        double vWaveSpeed = 2.0 * vString.mLength * 20e3 / (aModesNumber + 0.5);
+        double vLinDensity = vString.mDensity * Global::kPi * vString.mRadius * vString.mRadius;
+        vString.mTension = static_cast<float>(vWaveSpeed * vWaveSpeed * vLinDensity);
+        return vString;
+    }
+
+    std::unique_ptr<ModalStiffStringProcessor> MakeBowedProcessor(double aSampleRate, Global::Strings::String* apString)
+    {
+        auto vpProcessor = std::make_unique<ModalStiffStringProcessor>(aSampleRate, apString);
+        vpProcessor->SetInputPos(0.733f);
+        vpProcessor->SetReadPos(0.53f);
+        vpProcessor->SetGain(1000.f);
+        vpProcessor->SetBowSpeed(0.2f);
+        vpProcessor->SetBowPressure(10.f);
+        vpProcessor->SetPlayState(true);
+        return vpProcessor;
+    }
+
+    void MeasureModal(Tools::JsonWriter& aJson, const Options& aOptions, double aSampleRate, Global::Strings::String* apString)
+    {
+        auto vpProcessor = MakeBowedProcessor(aSampleRate, apString);
+        const int vModesNumber = vpProcessor->GetModesNumber();
+        const std::string vName = apString->mName;
+
+        //Lets the bow build up the motion first
+        std::vector<float> vOutput(4096);
+        vpProcessor->ProcessBlock(vOutput.data(), static_cast<int>(vOutput.size()));
+
+        Measure(aJson, aOptions, "ComputeState", vName, vModesNumber, [&]() { vpProcessor->ComputeState(); });
+
+        float vSink = 0.f;
+        Measure(aJson, aOptions, "ReadOutput", vName, vModesNumber, [&]() { vSink += vpProcessor->ReadOutput(); });
+
+        //Alternating positions, so that every call recomputes different modes
+        float vInputPos = 0.733f;
+        Measure(aJson, aOptions, "SetInputPos", vName, vModesNumber, [&]()
+            {
+                vInputPos = vInputPos == 0.733f ? 0.734f : 0.733f;
+                vpProcessor->SetInputPos(vInputPos);
+            });
+
+        float vReadPos = 0.53f;
+        Measure(aJson, aOptions, "SetReadPos", vName, vModesNumber, [&]()
+            {
+                vReadPos = vReadPos == 0.53f ? 0.531f : 0.53f;
+                vpProcessor->SetReadPos(vReadPos);
+            });
+
+        //Reallocates and recomputes every table, including the damping profile
+        Measure(aJson, aOptions, "SetString", vName, vModesNumber, [&]() { vpProcessor->SetString(apString); });
+
+        escape(&vSink);
+    }
+
+    void MeasureUtilities(Tools::JsonWriter& aJson, const Options& aOptions)
+    {
+        std::vector<double> vGrid(kGridPoints);
+        for (int i = 0; i < kGridPoints; ++i)
+        {
+            vGrid[i] = std::sin(2.0 * Global::kPi * i / kGridPoints);
+        }
+
+        //Walks the grid so that the index is not loop invariant
+        int vIndex = 1;
+        double vSink = 0.0;
+        Measure(aJson, aOptions, "cubicInterpolation", "Grid" + std::to_string(kGridPoints), 0, [&]()
+            {
+                vSink += Global::cubicInterpolation(vGrid.data(), vIndex, 0.37);
+                vIndex = vIndex + 1 < kGridPoints - 2 ? vIndex + 1 : 1;
+            });
+
+        Measure(aJson, aOptions, "cubicExtrapolation", "Grid" + std::to_string(kGridPoints), 0, [&]()
+            {
+                Global::cubicExtrapolation(vGrid.data(), vIndex, 0.37, 1e-9);
+                vIndex = vIndex + 1 < kGridPoints - 2 ? vIndex + 1 : 1;
+            });
+
+        PA_LowPass2 vFilter;
+        float vInput = 0.5f;
+        Measure(aJson, aOptions, "PA_LowPass2::update", "", 0, [&]()
+            {
+                vSink += vFilter.update(vInput);
+                vInput = -vInput;
+            });
+
+        escape(&vSink);
+        escape(vGrid.data());
+    }
+
+    //Single and batched evaluation of the friction terms, for each accuracy tier
+    void MeasureFriction(Tools::JsonWriter& aJson, const Options& aOptions)
+    {
+        const ModalKernels::Kernel& vKernel = *ModalKernels::GetKernel(ModalKernels::GetBestSupportedIsa());
+        std::vector<float> vEta(kFrictionBatch);
+        std::vector<float> vD(kFrictionBatch);
+        std::vector<float> vLambda(kFrictionBatch);
+        for (int i = 0; i < kFrictionBatch; ++i)
+        {
+            vEta[i] = -0.2f + 0.4f * i / kFrictionBatch;
+        }
+
+        for (auto vAccuracy : { BowFriction::Accuracy::Exact, BowFriction::Accuracy::Polynomial, BowFriction::Accuracy::Table })
+        {
+            BowFriction::Evaluator vFriction(100.f, vAccuracy);
+            const std::string vName = BowFriction::GetAccuracyName(vAccuracy);
+
+            int vIndex = 0;
+            Measure(aJson, aOptions, "BowFriction::Evaluate", vName, 0, [&]()
+                {
+                    vFriction.Evaluate(vKernel, vEta[vIndex], vD[vIndex], vLambda[vIndex]);
+                    vIndex = (vIndex + 1) % kFrictionBatch;
+                });
+
+            Measure(aJson, aOptions, "BowFriction::EvaluateBatch", vName, kFrictionBatch, [&]()
+                {
+                    vFriction.Evaluate(vKernel, vEta.data(), vD.data(), vLambda.data(), kFrictionBatch);
+                    escape(vD.data());
+                });
+        }
+        escape(vLambda.data());
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Tools::Arguments vArgs(argc, argv);
+    Options vOptions;
+    vOptions.mTrials = std::max(1, static_cast<int>(vArgs.GetDouble("trials", 31)));
+    vOptions.mFilter = vArgs.GetString("filter", "");
+    double vSampleRate = vArgs.GetDouble("sample-rate", 44100.0);
+    std::vector<double> vModes = vArgs.GetDoubleList("modes", "1000,2000,5000");
+
+    std::ofstream vFile;
+    if (vArgs.Has("output"))
+    {
+        vFile.open(vArgs.GetString("output", ""));
+        if (!vFile)
+        {
+            std::cerr << "Cannot open " << vArgs.GetString("output", "") << std::endl;
+            return 1;
+        }
+    }
+    Tools::JsonWriter vJson(vFile.is_open() ? static_cast<std::ostream&>(vFile) : std::cout);
+
+    vJson.BeginObject();
+    vJson.Field("sample_rate", vSampleRate);
+    vJson.Field("trials", vOptions.mTrials);
+    vJson.Key("results");
+    vJson.BeginArray();
+
+    for (auto& vPreset : Tools::GetPresets())
+    {
+        MeasureModal(vJson, vOptions, vSampleRate, vPreset.mpString);
+    }
+    for (double vModesNumber : vModes)
+    {
+        auto vString = MakeSyntheticString(static_cast<int>(vModesNumber));
+        MeasureModal(vJson, vOptions, vSampleRate, &vString);
+    }
+    MeasureUtilities(vJson, vOptions);
+    MeasureFriction(vJson, vOptions);
+
+    vJson.EndArray();
+    vJson.EndObject();
+    return 0;
+}
@@ -0,0 +1,349 @@
+/*
+  ==============================================================================
+
+    FastBowedStringRender.cpp
+    Created: 17/10/2026
+
+  ==============================================================================
+*/
+
+/*
+Offline renderer of the modal string, driven by an automation script and
+running as fast as the engine allows.
+
+Usage:
+    FastBowedStringRender automation.txt output.wav [--sample-rate 44100]
+                          [--duration 10] [--block 512] [--format wav|raw]
+                          [--isa avx2] [--no-limit]
+
+The automation script has one event per line, "<time in seconds> <parameter>
+<value>", with # starting a comment:
+
+    0     string    CelloG2
+    0     pressure  10
+    0.5   speed     0.3
+    2     pressure  0
+    3     end
+
+The parameters are pressure, speed, input and read (positions in portion of
+string length), gain, string (a preset name), play (1 or 0) and end, whose
+time sets the duration unless --duration is given. Events are applied at their
+exact sample. Before any event the string is CelloG2, playing, unbowed, with
+speed 0.2, input 0.733, read 0.53 and gain 1000.
+
+The output is mono float32, either a WAV file or raw little endian samples,
+chosen by --format or by the extension. Output values are limited to [-1, 1]
+as in the plugin, unless --no-limit is given. The script is memory mapped
+and the output is written through a sliding memory mapped window, so that
+renders of any length use a fixed amount of memory.
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "ToolsCommon.h"
+#include "MappedFile.h"
+#include "ModalStiffStringProcessor.h"
+
+namespace
+{
+    constexpr int kWavHeaderSize = Tools::kWavHeaderSize;
+
+    enum class Parameter
+    {
+        Pressure,
+        Speed,
+        Input,
+        Read,
+        Gain,
+        String,
+        Play,
+        End
+    };
+
+    struct Event
+    {
+        double mTime;
+        Parameter mParameter;
+        float mValue;
+        const Tools::Preset* mpPreset;
+    };
+
+    bool ParseParameter(const std::string& aName, Parameter& aParameter)
+    {
+        static const std::pair<const char*, Parameter> kNames[] = {
+            { "pressure", Parameter::Pressure }, { "speed", Parameter::Speed },
+            { "input", Parameter::Input }, { "read", Parameter::Read },
+            { "gain", Parameter::Gain }, { "string", Parameter::String },
+            { "play", Parameter::Play }, { "end", Parameter::End } };
+        for (auto& vName : kNames)
+        {
+            if (aName == vName.first)
+            {
+                aParameter = vName.second;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //Splits the line at spaces and tabs, dropping the comment
+    std::vector<std::string> Tokenize(const char* apBegin, const char* apEnd)
+    {
+        std::vector<std::string> vTokens;
+        std::string vToken;
+        for (const char* vpChar = apBegin; vpChar != apEnd && *vpChar != '#'; ++vpChar)
+        {
+            if (*vpChar == ' ' || *vpChar == '\t' || *vpChar == '\r')
+            {
+                if (!vToken.empty())
+                {
+                    vTokens.push_back(vToken);
+                    vToken.clear();
+                }
+            }
+            else
+            {
+                vToken += *vpChar;
+            }
+        }
+        if (!vToken.empty())
+        {
+            vTokens.push_back(vToken);
+        }
+        return vTokens;
+    }
+
+    bool IsPosition(float aValue)
+    {
+        return aValue >= 0.f && aValue <= 1.f;
+    }
+
+    //Parses the mapped script into events sorted by time, printing the first error
+    bool ParseScript(const char* apData, std::size_t aSize, std::vector<Event>& aEvents)
+    {
+        int vLineNumber = 0;
+        const char* vpLine = apData;
+        const char* const vpEnd = apData + aSize;
+        while (vpLine < vpEnd)
+        {
+            const char* vpLineEnd = std::find(vpLine, vpEnd, '\n');
+            ++vLineNumber;
+            auto vTokens = Tokenize(vpLine, vpLineEnd);
+            vpLine = vpLineEnd + 1;
+            if (vTokens.empty())
+            {
+                continue;
+            }
+
+            Event vEvent{ 0.0, Parameter::End, 0.f, nullptr };
+            char* vpParsed = nullptr;
+            vEvent.mTime = std::strtod(vTokens[0].c_str(), &vpParsed);
+            bool vIsValid = *vpParsed == '\0' && vEvent.mTime >= 0.0 && ParseParameter(vTokens.size() > 1 ? vTokens[1] : "", vEvent.mParameter);
+            if (vIsValid && vEvent.mParameter == Parameter::String)
+            {
+                vEvent.mpPreset = vTokens.size() == 3 ? Tools::FindPreset(vTokens[2]) : nullptr;
+                vIsValid = vEvent.mpPreset != nullptr;
+            }
+            else if (vIsValid && vEvent.mParameter != Parameter::End)
+            {
+                vIsValid = vTokens.size() == 3;
+                if (vIsValid)
+                {
+                    vEvent.mValue = std::strtof(vTokens[2].c_str(), &vpParsed);
+                    vIsValid = *vpParsed == '\0';
+                }
+                if (vIsValid && (vEvent.mParameter == Parameter::Input || vEvent.mParameter == Parameter::Read))
+                {
+                    vIsValid = IsPosition(vEvent.mValue);
+                }
+            }
+
+            if (!vIsValid)
+            {
+                std::cerr << "Invalid event at line " << vLineNumber << std::endl;
+                return false;
+            }
+            aEvents.push_back(vEvent);
+        }
+
+        std::stable_sort(aEvents.begin(), aEvents.end(), [](const Event& aA, const Event& aB) { return aA.mTime < aB.mTime; });
+        return true;
+    }
+
+    void Apply(ModalStiffStringProcessor& aProcessor, const Event& aEvent, float& aInputPos, float& aReadPos, bool& aPlayState)
+    {
+        switch (aEvent.mParameter)
+        {
+        case Parameter::Pressure:
+            aProcessor.SetBowPressure(aEvent.mValue);
+            break;
+        case Parameter::Speed:
+            aProcessor.SetBowSpeed(aEvent.mValue);
+            break;
+        case Parameter::Input:
+            aInputPos = aEvent.mValue;
+            aProcessor.SetInputPos(aInputPos);
+            break;
+        case Parameter::Read:
+            aReadPos = aEvent.mValue;
+            aProcessor.SetReadPos(aReadPos);
+            break;
+        case Parameter::Gain:
+            aProcessor.SetGain(aEvent.mValue);
+            break;
+        case Parameter::String:
+            //The new string starts at rest at the next block, with the
+            //positions and the play state set again as in the plugin before
+            aProcessor.SetString(aEvent.mpPreset->mpString);
+            aProcessor.SetInputPos(aInputPos);
+            aProcessor.SetReadPos(aReadPos);
+            aProcessor.SetPlayState(aPlayState);
+            break;
+        case Parameter::Play:
+            aPlayState = aEvent.mValue != 0.f;
+            aProcessor.SetPlayState(aPlayState);
+            break;
+        case Parameter::End:
+            break;
+        }
+    }
+}
+
+int main(int argc, char** argv)
+{
+    Tools::Arguments vArgs(argc, argv);
+    auto& vPaths = vArgs.GetPositionals();
+    if (vPaths.size() != 2)
+    {
+        std::cerr << "Usage: FastBowedStringRender automation.txt output.wav [--sample-rate 44100] [--duration seconds]"
+            " [--block 512] [--format wav|raw] [--isa name] [--no-limit]" << std::endl;
+        return 1;
+    }
+
+    const double vSampleRate = vArgs.GetDouble("sample-rate", 44100.0);
+    const int vBlockSize = std::max(1, static_cast<int>(vArgs.GetDouble("block", 512)));
+    const bool vIsLimited = !vArgs.Has("no-limit");
+    const std::string vOutputPath = vPaths[1];
+    bool vIsWav = vOutputPath.size() < 4 || vOutputPath.compare(vOutputPath.size() - 4, 4, ".raw") != 0;
+    if (vArgs.Has("format"))
+    {
+        vIsWav = vArgs.GetString("format", "wav") != "raw";
+    }
+
+    std::vector<Event> vEvents;
+    {
+        Tools::MappedReader vScript;
+        if (!vScript.Open(vPaths[0]))
+        {
+            std::cerr << "Cannot open " << vPaths[0] << std::endl;
+            return 1;
+        }
+        if (!ParseScript(vScript.GetData(), vScript.GetSize(), vEvents))
+        {
+            return 1;
+        }
+    }
+
+    //The duration is the --duration option, or else the last end event
+    double vDuration = vArgs.GetDouble("duration", -1.0);
+    for (auto& vEvent : vEvents)
+    {
+        if (vEvent.mParameter == Parameter::End && !vArgs.Has("duration"))
+        {
+            vDuration = vEvent.mTime;
+        }
+    }
+    if (vDuration <= 0.0)
+    {
+        std::cerr << "No duration, add an end event or --duration" << std::endl;
+        return 1;
+    }
+
+    const std::uint64_t vTotalSamples = static_cast<std::uint64_t>(std::llround(vDuration * vSampleRate));
+    const std::uint64_t vDataSize = 4 * vTotalSamples;
+    const std::uint64_t vHeaderSize = vIsWav ? kWavHeaderSize : 0;
+    if (vIsWav && vDataSize > 0xFFFFFFFFu - kWavHeaderSize)
+    {
+        std::cerr << "The output exceeds the 4 GB of a WAV file, use --format raw" << std::endl;
+        return 1;
+    }
+
+    Tools::MappedWriter vWriter;
+    if (!vWriter.Create(vOutputPath, vHeaderSize + vDataSize))
+    {
+        std::cerr << "Cannot create " << vOutputPath << std::endl;
+        return 1;
+    }
+    if (vIsWav)
+    {
+        unsigned char vHeader[kWavHeaderSize];
+        Tools::MakeWavHeader(vHeader, static_cast<std::uint32_t>(vSampleRate), static_cast<std::uint32_t>(vDataSize));
+        vWriter.Write(0, vHeader, kWavHeaderSize);
+    }
+
+    ModalStiffStringProcessor vProcessor(vSampleRate, Global::Strings::kpCelloG2);
+    if (vArgs.Has("isa"))
+    {
+        ModalKernels::Isa vIsa;
+        if (!Tools::ParseIsa(vArgs.GetString("isa", ""), vIsa) || !vProcessor.SetKernelIsa(vIsa))
+        {
+            std::cerr << "Unsupported instruction set " << vArgs.GetString("isa", "") << std::endl;
+            return 1;
+        }
+    }
+    float vInputPos = 0.733f;
+    float vReadPos = 0.53f;
+    bool vPlayState = true;
+    vProcessor.SetInputPos(vInputPos);
+    vProcessor.SetReadPos(vReadPos);
+    vProcessor.SetBowSpeed(0.2f);
+    vProcessor.SetBowPressure(0.f);
+    vProcessor.SetGain(1000.f);
+    vProcessor.SetPlayState(vPlayState);
+
+    std::vector<float> vBlock(vBlockSize);
+    std::vector<unsigned char> vBytes(4 * static_cast<std::size_t>(vBlockSize));
+    std::size_t vNextEvent = 0;
+    std::uint64_t vSample = 0;
+
+    auto vStart = std::chrono::steady_clock::now();
+    while (vSample < vTotalSamples)
+    {
+        //Events due at this sample, then a block up to the next event
+        while (vNextEvent < vEvents.size() && std::llround(vEvents[vNextEvent].mTime * vSampleRate) <= static_cast<long long>(vSample))
+        {
+            Apply(vProcessor, vEvents[vNextEvent++], vInputPos, vReadPos, vPlayState);
+        }
+        std::uint64_t vBlockEnd = std::min<std::uint64_t>(vTotalSamples, vSample + vBlockSize);
+        if (vNextEvent < vEvents.size())
+        {
+            vBlockEnd = std::min<std::uint64_t>(vBlockEnd, static_cast<std::uint64_t>(std::llround(vEvents[vNextEvent].mTime * vSampleRate)));
+        }
+        const int vNumSamples = static_cast<int>(vBlockEnd - vSample);
+
+        vProcessor.ProcessBlock(vBlock.data(), vNumSamples);
+        for (int i = 0; i < vNumSamples; ++i)
+        {
+            Tools::StoreFloatLE(vBytes.data() + 4 * i, vIsLimited ? Global::limitOutput(vBlock[i]) : vBlock[i]);
+        }
+        if (!vWriter.Write(vHeaderSize + 4 * vSample, vBytes.data(), 4 * static_cast<std::size_t>(vNumSamples)))
+        {
+            std::cerr << "Cannot write " << vOutputPath << std::endl;
+            return 1;
+        }
+        vSample = vBlockEnd;
+    }
+    vWriter.Close();
+
+    double vSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - vStart).count();
+    std::cerr << "Rendered " << vDuration << " s in " << vSeconds << " s, "
+        << (vSeconds > 0.0 ? vDuration / vSeconds : 0.0) << "x real time" << std::endl;
+    return 0;
+}
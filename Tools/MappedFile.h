@@ -0,0 +1,269 @@
+/*
+  ==============================================================================
+
+    MappedFile.h
+    Created: 17/10/2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#if defined(_WIN32)
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/*
+Memory mapped files for the command line tools. MappedReader maps a whole file
+read-only. MappedWriter creates a file of known size and maps it one window at
+a time, so that long outputs are streamed to disk by the OS instead of being
+held in memory.
+*/
+namespace Tools
+{
+    class MappedReader
+    {
+    public:
+        MappedReader() = default;
+        ~MappedReader() { Close(); }
+
+        MappedReader(const MappedReader&) = delete;
+        MappedReader& operator=(const MappedReader&) = delete;
+
+        //Returns false if the file cannot be opened or mapped
+        bool Open(const std::string& aPath)
+        {
+            Close();
+#if defined(_WIN32)
+            mFile = CreateFileA(aPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (mFile == INVALID_HANDLE_VALUE)
+            {
+                return false;
+            }
+            LARGE_INTEGER vSize;
+            GetFileSizeEx(mFile, &vSize);
+            mSize = static_cast<std::size_t>(vSize.QuadPart);
+            if (mSize == 0)
+            {
+                return true;
+            }
+            mMapping = CreateFileMappingA(mFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            mpData = mMapping ? static_cast<const char*>(MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+#else
+            mFile = open(aPath.c_str(), O_RDONLY);
+            if (mFile < 0)
+            {
+                return false;
+            }
+            struct stat vStat;
+            fstat(mFile, &vStat);
+            mSize = static_cast<std::size_t>(vStat.st_size);
+            if (mSize == 0)
+            {
+                return true;
+            }
+            void* vpData = mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, mFile, 0);
+            mpData = vpData == MAP_FAILED ? nullptr : static_cast<const char*>(vpData);
+#endif
+            return mpData != nullptr;
+        }
+
+        void Close()
+        {
+#if defined(_WIN32)
+            if (mpData)
+            {
+                UnmapViewOfFile(mpData);
+            }
+            if (mMapping)
+            {
+                CloseHandle(mMapping);
+            }
+            if (mFile != INVALID_HANDLE_VALUE)
+            {
+                CloseHandle(mFile);
+            }
+            mMapping = nullptr;
+            mFile = INVALID_HANDLE_VALUE;
+#else
+            if (mpData)
+            {
+                munmap(const_cast<char*>(mpData), mSize);
+            }
+            if (mFile >= 0)
+            {
+                close(mFile);
+            }
+            mFile = -1;
+#endif
+            mpData = nullptr;
+            mSize = 0;
+        }
+
+        const char* GetData() const { return mpData; }
+        std::size_t GetSize() const { return mSize; }
+
+    private:
+        const char* mpData{ nullptr };
+        std::size_t mSize{ 0 };
+#if defined(_WIN32)
+        HANDLE mFile{ INVALID_HANDLE_VALUE };
+        HANDLE mMapping{ nullptr };
+#else
+        int mFile{ -1 };
+#endif
+    };
+
+    class MappedWriter
+    {
+    public:
+        //Multiple of the page size and of the Windows allocation granularity
+        static constexpr std::uint64_t kWindowSize = 16 * 1024 * 1024;
+
+        MappedWriter() = default;
+        ~MappedWriter() { Close(); }
+
+        MappedWriter(const MappedWriter&) = delete;
+        MappedWriter& operator=(const MappedWriter&) = delete;
+
+        //Creates or truncates aPath to aSize bytes, returns false on failure
+        bool Create(const std::string& aPath, std::uint64_t aSize)
+        {
+            Close();
+            mSize = aSize;
+#if defined(_WIN32)
+            mFile = CreateFileA(aPath.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+            if (mFile == INVALID_HANDLE_VALUE)
+            {
+                return false;
+            }
+            if (aSize == 0)
+            {
+                return true;
+            }
+            mMapping = CreateFileMappingA(mFile, nullptr, PAGE_READWRITE,
+                static_cast<DWORD>(aSize >> 32), static_cast<DWORD>(aSize & 0xFFFFFFFFu), nullptr);
+            return mMapping != nullptr;
+#else
+            mFile = open(aPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+            if (mFile < 0)
+            {
+                return false;
+            }
+            return ftruncate(mFile, static_cast<off_t>(aSize)) == 0;
+#endif
+        }
+
+        /*
+        Writes aNumBytes at aOffset, mapping the windows it spans. Writes are
+        expected in increasing offsets, the previous window is unmapped as
+        soon as a later one is needed.
+        */
+        bool Write(std::uint64_t aOffset, const void* apData, std::size_t aNumBytes)
+        {
+            const char* vpSrc = static_cast<const char*>(apData);
+            while (aNumBytes > 0)
+            {
+                std::uint64_t vWindowStart = aOffset - aOffset % kWindowSize;
+                if (vWindowStart != mWindowStart || !mpWindow)
+                {
+                    if (!MapWindow(vWindowStart))
+                    {
+                        return false;
+                    }
+                }
+                std::size_t vInWindow = static_cast<std::size_t>(aOffset - mWindowStart);
+                std::size_t vNumBytes = aNumBytes < mWindowSize - vInWindow ? aNumBytes : mWindowSize - vInWindow;
+                std::memcpy(mpWindow + vInWindow, vpSrc, vNumBytes);
+                vpSrc += vNumBytes;
+                aOffset += vNumBytes;
+                aNumBytes -= vNumBytes;
+            }
+            return true;
+        }
+
+        void Close()
+        {
+            UnmapWindow();
+#if defined(_WIN32)
+            if (mMapping)
+            {
+                CloseHandle(mMapping);
+            }
+            if (mFile != INVALID_HANDLE_VALUE)
+            {
+                CloseHandle(mFile);
+            }
+            mMapping = nullptr;
+            mFile = INVALID_HANDLE_VALUE;
+#else
+            if (mFile >= 0)
+            {
+                close(mFile);
+            }
+            mFile = -1;
+#endif
+        }
+
+    private:
+        std::uint64_t mSize{ 0 };
+        char* mpWindow{ nullptr };
+        std::uint64_t mWindowStart{ 0 };
+        std::size_t mWindowSize{ 0 };
+#if defined(_WIN32)
+        HANDLE mFile{ INVALID_HANDLE_VALUE };
+        HANDLE mMapping{ nullptr };
+#else
+        int mFile{ -1 };
+#endif
+
+        bool MapWindow(std::uint64_t aStart)
+        {
+            UnmapWindow();
+            if (aStart >= mSize)
+            {
+                return false;
+            }
+            mWindowStart = aStart;
+            mWindowSize = static_cast<std::size_t>(mSize - aStart < kWindowSize ? mSize - aStart : kWindowSize);
+#if defined(_WIN32)
+            mpWindow = static_cast<char*>(MapViewOfFile(mMapping, FILE_MAP_WRITE,
+                static_cast<DWORD>(aStart >> 32), static_cast<DWORD>(aStart & 0xFFFFFFFFu), mWindowSize));
+#else
+            void* vpWindow = mmap(nullptr, mWindowSize, PROT_READ | PROT_WRITE, MAP_SHARED, mFile, static_cast<off_t>(aStart));
+            mpWindow = vpWindow == MAP_FAILED ? nullptr : static_cast<char*>(vpWindow);
+#endif
+            return mpWindow != nullptr;
+        }
+
+        void UnmapWindow()
+        {
+            if (!mpWindow)
+            {
+                return;
+            }
+#if defined(_WIN32)
+            UnmapViewOfFile(mpWindow);
+#else
+            munmap(mpWindow, mWindowSize);
+#endif
+            mpWindow = nullptr;
+        }
+    };
+}
@@ -0,0 +1,323 @@
+/*
+  ==============================================================================
+
+    ToolsCommon.h
+    Created: 17/10/2026
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <cctype>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "Global.h"
+#include "ModalKernels.h"
+
+/*
+Helpers shared by the command line tools: the presets, the kernel names, a
+minimal argument parser, little endian samples and WAV headers, and a JSON
+writer for machine-readable reports.
+*/
+namespace Tools
+{
+    struct Preset
+    {
+        const Global::Strings::StringParams* mpParams;
+        Global::Strings::String* mpString;
+    };
+
+    inline std::vector<Preset> GetPresets()
+    {
+        using namespace Global::Strings;
+        return { { &kCelloA3Params, kpCelloA3 },
+                 { &kCelloD3Params, kpCelloD3 },
+                 { &kCelloG2Params, kpCelloG2 },
+                 { &kCelloC2Params, kpCelloC2 } };
+    }
+
+    //Returns nullptr if no preset is called aName
+    inline const Preset* FindPreset(const std::string& aName)
+    {
+        static const std::vector<Preset> sPresets = GetPresets();
+        for (auto& vPreset : sPresets)
+        {
+            if (aName == vPreset.mpParams->mName)
+            {
+                return &vPreset;
+            }
+        }
+        return nullptr;
+    }
+
+    //Instruction set name for the command line, lower case without dashes, e.g. avx512
+    inline std::string GetIsaKey(ModalKernels::Isa aIsa)
+    {
+        std::string vKey;
+        for (const char* vpChar = ModalKernels::GetIsaName(aIsa); *vpChar; ++vpChar)
+        {
+            if (*vpChar != '-')
+            {
+                vKey += static_cast<char>(std::tolower(static_cast<unsigned char>(*vpChar)));
+            }
+        }
+        return vKey;
+    }
+
+    inline bool ParseIsa(const std::string& aKey, ModalKernels::Isa& aIsa)
+    {
+        for (auto vIsa : { ModalKernels::Isa::Scalar, ModalKernels::Isa::Sse2, ModalKernels::Isa::Avx2, ModalKernels::Isa::Avx512 })
+        {
+            if (GetIsaKey(vIsa) == aKey)
+            {
+                aIsa = vIsa;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //Float samples as little endian bytes, whatever the host
+    inline void StoreFloatLE(unsigned char* apBytes, float aSample)
+    {
+        std::uint32_t vBits;
+        std::memcpy(&vBits, &aSample, sizeof(vBits));
+        for (int i = 0; i < 4; ++i)
+        {
+            apBytes[i] = static_cast<unsigned char>(vBits >> (8 * i));
+        }
+    }
+
+    inline float LoadFloatLE(const unsigned char* apBytes)
+    {
+        std::uint32_t vBits = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+            vBits |= static_cast<std::uint32_t>(apBytes[i]) << (8 * i);
+        }
+        float vSample;
+        std::memcpy(&vSample, &vBits, sizeof(vSample));
+        return vSample;
+    }
+
+    constexpr int kWavHeaderSize = 44;
+
+    //Canonical 44 bytes header of a mono IEEE float WAV file
+    inline void MakeWavHeader(unsigned char* apHeader, std::uint32_t aSampleRate, std::uint32_t aDataSize)
+    {
+        auto Store32 = [](unsigned char* apBytes, std::uint32_t aValue)
+        {
+            for (int i = 0; i < 4; ++i)
+            {
+                apBytes[i] = static_cast<unsigned char>(aValue >> (8 * i));
+            }
+        };
+        auto Store16 = [](unsigned char* apBytes, std::uint16_t aValue)
+        {
+            apBytes[0] = static_cast<unsigned char>(aValue);
+            apBytes[1] = static_cast<unsigned char>(aValue >> 8);
+        };
+
+        std::memcpy(apHeader, "RIFF", 4);
+        Store32(apHeader + 4, 36 + aDataSize);
+        std::memcpy(apHeader + 8, "WAVEfmt ", 8);
+        Store32(apHeader + 16, 16);
+        Store16(apHeader + 20, 3);                  //WAVE_FORMAT_IEEE_FLOAT
+        Store16(apHeader + 22, 1);                  //Channels
+        Store32(apHeader + 24, aSampleRate);
+        Store32(apHeader + 28, aSampleRate * 4);    //Bytes per second
+        Store16(apHeader + 32, 4);                  //Block align
+        Store16(apHeader + 34, 32);                 //Bits per sample
+        std::memcpy(apHeader + 36, "data", 4);
+        Store32(apHeader + 40, aDataSize);
+    }
+
+    //Arguments in the form --key value, flags without value are set to "1"
+    class Arguments
+    {
+    public:
+        Arguments(int argc, char** argv)
+        {
+            for (int i = 1; i < argc; ++i)
+            {
+                std::string vArg = argv[i];
+                if (vArg.rfind("--", 0) != 0)
+                {
+                    mPositionals.push_back(vArg);
+                    continue;
+                }
+                vArg = vArg.substr(2);
+                if (i + 1 < argc && std::string(argv[i + 1]).rfind("--", 0) != 0)
+                {
+                    mValues[vArg] = argv[++i];
+                }
+                else
+                {
+                    mValues[vArg] = "1";
+                }
+            }
+        }
+
+        bool Has(const std::string& aKey) const
+        {
+            return mValues.count(aKey) > 0;
+        }
+
+        std::string GetString(const std::string& aKey, const std::string& aDefault) const
+        {
+            auto vIt = mValues.find(aKey);
+            return vIt == mValues.end() ? aDefault : vIt->second;
+        }
+
+        double GetDouble(const std::string& aKey, double aDefault) const
+        {
+            auto vIt = mValues.find(aKey);
+            return vIt == mValues.end() ? aDefault : std::atof(vIt->second.c_str());
+        }
+
+        //Comma separated list
+        std::vector<std::string> GetList(const std::string& aKey, const std::string& aDefault) const
+        {
+            std::vector<std::string> vList;
+            std::stringstream vStream(GetString(aKey, aDefault));
+            std::string vItem;
+            while (std::getline(vStream, vItem, ','))
+            {
+                if (!vItem.empty())
+                {
+                    vList.push_back(vItem);
+                }
+            }
+            return vList;
+        }
+
+        std::vector<double> GetDoubleList(const std::string& aKey, const std::string& aDefault) const
+        {
+            std::vector<double> vList;
+            for (auto& vItem : GetList(aKey, aDefault))
+            {
+                vList.push_back(std::atof(vItem.c_str()));
+            }
+            return vList;
+        }
+
+        const std::vector<std::string>& GetPositionals() const
+        {
+            return mPositionals;
+        }
+
+    private:
+        std::map<std::string, std::string> mValues;
+        std::vector<std::string> mPositionals;
+    };
+
+    //Streams JSON with one value per line, commas and indentation are handled here
+    class JsonWriter
+    {
+    public:
+        explicit JsonWriter(std::ostream& aStream) : mStream(aStream) {}
+
+        void BeginObject() { Open('{'); }
+        void EndObject() { Close('}'); }
+        void BeginArray() { Open('['); }
+        void EndArray() { Close(']'); }
+
+        void Key(const std::string& aKey)
+        {
+            Separate();
+            WriteString(aKey);
+            mStream << ": ";
+            mIsAfterKey = true;
+        }
+
+        void Value(const std::string& aValue) { Separate(); WriteString(aValue); }
+        void Value(const char* apValue) { Value(std::string(apValue)); }
+        void Value(bool aValue) { Separate(); mStream << (aValue ? "true" : "false"); }
+        void Value(int aValue) { Separate(); mStream << aValue; }
+        void Value(long long aValue) { Separate(); mStream << aValue; }
+
+        void Value(double aValue)
+        {
+            Separate();
+            //JSON has no representation of inf and nan
+            if (aValue != aValue || aValue - aValue != 0)
+            {
+                mStream << "null";
+                return;
+            }
+            std::ostringstream vNumber;
+            vNumber.precision(9);
+            vNumber << aValue;
+            mStream << vNumber.str();
+        }
+
+        template <class T>
+        void Field(const std::string& aKey, T aValue)
+        {
+            Key(aKey);
+            Value(aValue);
+        }
+
+    private:
+        std::ostream& mStream;
+        std::vector<bool> mHasItems;
+        bool mIsAfterKey{ false };
+
+        void Separate()
+        {
+            if (mIsAfterKey)
+            {
+                mIsAfterKey = false;
+                return;
+            }
+            if (!mHasItems.empty())
+            {
+                mStream << (mHasItems.back() ? ",\n" : "\n") << std::string(2 * mHasItems.size(), ' ');
+                mHasItems.back() = true;
+            }
+        }
+
+        void Open(char aBracket)
+        {
+            Separate();
+            mStream << aBracket;
+            mHasItems.push_back(false);
+        }
+
+        void Close(char aBracket)
+        {
+            bool vHadItems = mHasItems.back();
+            mHasItems.pop_back();
+            if (vHadItems)
+            {
+                mStream << "\n" << std::string(2 * mHasItems.size(), ' ');
+            }
+            mStream << aBracket;
+            if (mHasItems.empty())
+            {
+                mStream << "\n";
+            }
+        }
+
+        void WriteString(const std::string& aString)
+        {
+            mStream << '"';
+            for (char vChar : aString)
+            {
+                if (vChar == '"' || vChar == '\\')
+                {
+                    mStream << '\\';
+                }
+                mStream << vChar;
+            }
+            mStream << '"';
+        }
+    };
+}